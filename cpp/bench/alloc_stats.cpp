@@ -0,0 +1,126 @@
+// Part of the Chili3d Project, under the AGPL-3.0 License.
+// See LICENSE file in the project root for full license information.
+
+// Counts the heap allocations of chili-wasm-bench. OCCT allocates through Standard::Allocate, which is
+// plain malloc unless MMGT_OPT is set, so wrapping the builtin allocator also sees what operator new
+// does not. Only linked into the benchmark module.
+
+#include <emscripten/bind.h>
+#include <emscripten/heap.h>
+
+#include <malloc.h>
+
+#include <cstdint>
+
+using namespace emscripten;
+
+namespace {
+
+struct AllocCounters {
+    uint64_t count;
+    uint64_t bytes;
+    int64_t live;
+    int64_t peak;
+};
+
+AllocCounters counters {};
+
+void recordAlloc(void* ptr)
+{
+    if (ptr == nullptr) {
+        return;
+    }
+    auto size = static_cast<int64_t>(malloc_usable_size(ptr));
+    counters.count++;
+    counters.bytes += size;
+    counters.live += size;
+    if (counters.live > counters.peak) {
+        counters.peak = counters.live;
+    }
+}
+
+void recordFree(void* ptr)
+{
+    if (ptr != nullptr) {
+        counters.live -= static_cast<int64_t>(malloc_usable_size(ptr));
+    }
+}
+
+} // namespace
+
+extern "C" {
+
+void* malloc(size_t size)
+{
+    void* ptr = emscripten_builtin_malloc(size);
+    recordAlloc(ptr);
+    return ptr;
+}
+
+void* calloc(size_t count, size_t size)
+{
+    void* ptr = emscripten_builtin_calloc(count, size);
+    recordAlloc(ptr);
+    return ptr;
+}
+
+void* realloc(void* ptr, size_t size)
+{
+    recordFree(ptr);
+    void* result = emscripten_builtin_realloc(ptr, size);
+    if (result == nullptr && ptr != nullptr && size > 0) {
+        // the block was left untouched
+        counters.live += static_cast<int64_t>(malloc_usable_size(ptr));
+        return result;
+    }
+    recordAlloc(result);
+    return result;
+}
+
+void free(void* ptr)
+{
+    recordFree(ptr);
+    emscripten_builtin_free(ptr);
+}
+}
+
+/// @brief The counters since the last reset, peak is the highest live heap above the live heap at reset.
+class AllocStats {
+public:
+    static void reset()
+    {
+        counters.count = 0;
+        counters.bytes = 0;
+        counters.peak = counters.live;
+    }
+
+    static double count()
+    {
+        return static_cast<double>(counters.count);
+    }
+
+    static double bytes()
+    {
+        return static_cast<double>(counters.bytes);
+    }
+
+    static double live()
+    {
+        return static_cast<double>(counters.live);
+    }
+
+    static double peak()
+    {
+        return static_cast<double>(counters.peak);
+    }
+};
+
+EMSCRIPTEN_BINDINGS(AllocStats)
+{
+    class_<AllocStats>("AllocStats")
+        .class_function("reset", &AllocStats::reset)
+        .class_function("count", &AllocStats::count)
+        .class_function("bytes", &AllocStats::bytes)
+        .class_function("live", &AllocStats::live)
+        .class_function("peak", &AllocStats::peak);
+}
@@ -0,0 +1,167 @@
+// Part of the Chili3d Project, under the AGPL-3.0 License.
+// See LICENSE file in the project root for full license information.
+
+// Compares DxfDocument::parse with the getline/std::map parser it replaced on a generated drawing.
+// Usage: dxf-bench [megabytes]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../src/dxf.hpp"
+
+namespace legacy {
+
+struct DxfEntity {
+    std::string type;
+    std::map<int, std::string> groupCodes;
+    std::string layer;
+    std::string color;
+
+    DxfEntity(const std::string& entityType)
+        : type(entityType)
+    {
+    }
+};
+
+// the parser of Converter::parseDxfEntities before the tokenizer, group values are converted with
+// std::stod afterwards the way createLineFromDxf did
+std::vector<DxfEntity> parseDxfEntities(const std::string& content)
+{
+    std::vector<DxfEntity> entities;
+    std::istringstream stream(content);
+    std::string line;
+    DxfEntity* currentEntity = nullptr;
+    std::string currentLayer = "0";
+
+    while (std::getline(stream, line)) {
+        line.erase(0, line.find_first_not_of(" \t\r\n"));
+        line.erase(line.find_last_not_of(" \t\r\n") + 1);
+
+        if (line.empty())
+            continue;
+
+        if (std::isdigit(line[0]) || (line[0] == '-' && line.length() > 1 && std::isdigit(line[1]))) {
+            int groupCode = std::stoi(line);
+
+            if (std::getline(stream, line)) {
+                line.erase(0, line.find_first_not_of(" \t\r\n"));
+                line.erase(line.find_last_not_of(" \t\r\n") + 1);
+
+                if (groupCode == 0) {
+                    if (currentEntity) {
+                        currentEntity->layer = currentLayer;
+                        entities.push_back(*currentEntity);
+                        delete currentEntity;
+                    }
+                    currentEntity = new DxfEntity(line);
+                } else if (currentEntity) {
+                    currentEntity->groupCodes[groupCode] = line;
+                    if (groupCode == 8) {
+                        currentLayer = line;
+                    }
+                    if (groupCode == 62) {
+                        currentEntity->color = line;
+                    }
+                }
+            }
+        }
+    }
+
+    if (currentEntity) {
+        currentEntity->layer = currentLayer;
+        entities.push_back(*currentEntity);
+        delete currentEntity;
+    }
+
+    return entities;
+}
+
+double sumCoordinates(const std::vector<DxfEntity>& entities)
+{
+    double sum = 0;
+    for (const auto& entity : entities) {
+        for (int code : { 10, 20, 11, 21 }) {
+            auto it = entity.groupCodes.find(code);
+            if (it != entity.groupCodes.end()) {
+                sum += std::stod(it->second);
+            }
+        }
+    }
+    return sum;
+}
+
+} // namespace legacy
+
+static std::string generateDrawing(size_t targetBytes)
+{
+    std::string content = "  0\nSECTION\n  2\nENTITIES\n";
+    content.reserve(targetBytes + 1024);
+    for (int i = 0; content.size() < targetBytes; i++) {
+        double x = i % 1000, y = i / 1000;
+        char buffer[512];
+        if (i % 4 == 3) {
+            std::snprintf(buffer, sizeof(buffer),
+                "  0\nLWPOLYLINE\n  8\nLayer%d\n 62\n%d\n 90\n3\n 70\n1\n 10\n%.6f\n 20\n%.6f\n 10\n%.6f\n 20\n%.6f\n 10\n%.6f\n 20\n%.6f\n",
+                i % 16, i % 7 + 1, x, y, x + 0.5, y, x + 0.5, y + 0.5);
+        } else {
+            std::snprintf(buffer, sizeof(buffer),
+                "  0\nLINE\n  8\nLayer%d\n 62\n%d\n 10\n%.6f\n 20\n%.6f\n 30\n0.0\n 11\n%.6f\n 21\n%.6f\n 31\n0.0\n",
+                i % 16, i % 7 + 1, x, y, x + 1.25, y + 0.75);
+        }
+        content += buffer;
+    }
+    content += "  0\nENDSEC\n  0\nEOF\n";
+    return content;
+}
+
+template <typename Function>
+static double measure(Function&& function)
+{
+    auto start = std::chrono::steady_clock::now();
+    function();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char** argv)
+{
+    size_t megabytes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 50;
+    std::string content = generateDrawing(megabytes << 20);
+
+    size_t legacyCount = 0, legacyVertices = 0;
+    double legacySum = 0;
+    double legacyTime = measure([&] {
+        auto entities = legacy::parseDxfEntities(content);
+        legacySum = legacy::sumCoordinates(entities);
+        legacyCount = entities.size();
+        for (const auto& entity : entities) {
+            legacyVertices += entity.groupCodes.count(10);
+        }
+    });
+
+    size_t count = 0, vertices = 0;
+    double sum = 0;
+    double time = measure([&] {
+        auto document = DxfDocument::parse(content);
+        for (const auto& entity : document.entities) {
+            for (int code : { 10, 20, 11, 21 }) {
+                sum += document.number(entity, code).value_or(0);
+            }
+            vertices += document.vertices(entity).size() / 3;
+        }
+        count = document.entities.size();
+    });
+
+    std::printf("input         %zu MB\n", content.size() >> 20);
+    // the legacy parser also counts the SECTION/ENDSEC/EOF markers as entities and keeps one vertex
+    // per LWPOLYLINE
+    std::printf("legacy        %9.1f ms, %zu entities, %zu vertices, checksum %.3f\n", legacyTime, legacyCount,
+        legacyVertices, legacySum);
+    std::printf("DxfDocument   %9.1f ms, %zu entities, %zu vertices, checksum %.3f\n", time, count, vertices, sum);
+    std::printf("speedup       %9.2fx\n", legacyTime / time);
+    return 0;
+}
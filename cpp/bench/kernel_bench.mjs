@@ -0,0 +1,190 @@
+// Part of the Chili3d Project, under the AGPL-3.0 License.
+// See LICENSE file in the project root for full license information.
+
+// Times the heavy kernel operations of chili-wasm-bench under node and reports the heap allocations
+// counted by bench/alloc_stats.cpp. The corpus is generated, --step and --dxf replace the generated
+// STEP assembly and DXF drawing with real files.
+// Usage: node kernel_bench.mjs <chili-wasm-bench.js> [--repeat n] [--step file] [--dxf file]
+
+import { readFileSync } from "node:fs";
+import { resolve } from "node:path";
+import { pathToFileURL } from "node:url";
+
+function parseArgs(argv) {
+    const args = { module: argv[0], repeat: 3, step: undefined, dxf: undefined };
+    for (let i = 1; i < argv.length; i += 2) {
+        const name = argv[i].replace(/^--/, "");
+        if (!(name in args)) {
+            throw new Error(`unknown option ${argv[i]}`);
+        }
+        args[name] = name === "repeat" ? Number(argv[i + 1]) : argv[i + 1];
+    }
+    if (!args.module) {
+        throw new Error("usage: node kernel_bench.mjs <chili-wasm-bench.js> [--repeat n] [--step file] [--dxf file]");
+    }
+    return args;
+}
+
+const args = parseArgs(process.argv.slice(2));
+const { default: createModule } = await import(pathToFileURL(resolve(args.module)).href);
+const wasm = await createModule();
+
+const vec = (x, y, z) => ({ x, y, z });
+const pln = (x, y, z) => ({ location: vec(x, y, z), direction: vec(0, 0, 1), xDirection: vec(1, 0, 0) });
+
+function unwrap(result, name) {
+    if (!result.isOk) {
+        throw new Error(`${name}: ${result.error}`);
+    }
+    return result.shape;
+}
+
+// 8 x 5 through holes in a plate, the tools of the boolean benchmarks.
+function plateWithTools() {
+    const plate = unwrap(wasm.ShapeFactory.box(pln(0, 0, 0), 160, 100, 10), "box");
+    const tools = [];
+    for (let i = 0; i < 8; i++) {
+        for (let j = 0; j < 5; j++) {
+            const center = vec(12 + i * 19, 12 + j * 19, -1);
+            tools.push(unwrap(wasm.ShapeFactory.cylinder(vec(0, 0, 1), center, 5, 12), "cylinder"));
+        }
+    }
+    return { plate, tools };
+}
+
+// A base with ribs, fused and unified so every edge is a line that can be filleted.
+function ribbedPart() {
+    const base = unwrap(wasm.ShapeFactory.box(pln(0, 0, 0), 120, 60, 8), "box");
+    const ribs = [];
+    for (let i = 0; i < 10; i++) {
+        ribs.push(unwrap(wasm.ShapeFactory.box(pln(6 + i * 11.5, 5, 8), 4, 50, 20), "box"));
+    }
+    const fused = unwrap(wasm.ShapeFactory.booleanFuse([base], ribs), "fuse");
+    return unwrap(wasm.ShapeFactory.simplifyShape(fused, true, true), "simplify");
+}
+
+// A grid of boxes and cylinders, the kind of flat assembly a STEP import produces.
+function assemblyParts(count) {
+    const parts = [];
+    for (let i = 0; i < count; i++) {
+        const x = (i % 20) * 30;
+        const y = Math.floor(i / 20) * 30;
+        const result =
+            i % 2 === 0
+                ? wasm.ShapeFactory.box(pln(x, y, 0), 20, 20, 10 + (i % 7))
+                : wasm.ShapeFactory.cylinder(vec(0, 0, 1), vec(x + 10, y + 10, 0), 8, 10 + (i % 5));
+        parts.push(unwrap(result, "part"));
+    }
+    return parts;
+}
+
+function generateDrawing(entityCount) {
+    const chunks = ["  0\nSECTION\n  2\nENTITIES\n"];
+    for (let i = 0; i < entityCount; i++) {
+        const x = (i % 1000).toFixed(6);
+        const y = Math.floor(i / 1000);
+        const layer = `  8\nLayer${i % 16}\n`;
+        if (i % 8 === 7) {
+            chunks.push(`  0\nCIRCLE\n${layer} 10\n${x}\n 20\n${y.toFixed(6)}\n 30\n0.0\n 40\n0.3\n`);
+        } else if (i % 4 === 3) {
+            chunks.push(`  0\nARC\n${layer} 10\n${x}\n 20\n${y.toFixed(6)}\n 30\n0.0\n 40\n0.4\n 50\n0.0\n 51\n90.0\n`);
+        } else {
+            chunks.push(`  0\nLINE\n${layer} 10\n${x}\n 20\n${y.toFixed(6)}\n 30\n0.0\n 11\n${x}\n 21\n${(y + 0.75).toFixed(6)}\n 31\n0.0\n`);
+        }
+    }
+    chunks.push("  0\nENDSEC\n  0\nEOF\n");
+    return new TextEncoder().encode(chunks.join(""));
+}
+
+const booleanOptions = {
+    parallel: true,
+    fuzzyValue: 0,
+    useOBB: true,
+    glue: wasm.BOPAlgo_GlueEnum.BOPAlgo_GlueOff,
+    nonDestructive: false,
+};
+
+function clearCaches() {
+    wasm.MeshCache.clear();
+    wasm.EdgeDiscretizer.clear();
+    wasm.ShapeCache.clear();
+}
+
+const results = [];
+
+// Runs the operation `repeat` times and keeps the median time, the allocation counters are those of
+// the median run. dispose receives the value of every run.
+function bench(name, operation, dispose = () => {}) {
+    const runs = [];
+    for (let i = 0; i < args.repeat; i++) {
+        clearCaches();
+        wasm.AllocStats.reset();
+        const live = wasm.AllocStats.live();
+        const start = performance.now();
+        const value = operation();
+        const time = performance.now() - start;
+        runs.push({
+            time,
+            count: wasm.AllocStats.count(),
+            bytes: wasm.AllocStats.bytes(),
+            peak: wasm.AllocStats.peak() - live,
+        });
+        dispose(value);
+    }
+    runs.sort((a, b) => a.time - b.time);
+    results.push({ name, ...runs[Math.floor(runs.length / 2)] });
+}
+
+const deleteResult = (result) => result?.delete();
+const deleteMesh = (mesher) => {
+    mesher.release();
+    mesher.delete();
+};
+
+const stepParts = assemblyParts(400);
+const stepBytes = args.step
+    ? new Uint8Array(readFileSync(args.step))
+    : new TextEncoder().encode(wasm.Converter.convertToStep(stepParts));
+const dxfBytes = args.dxf ? new Uint8Array(readFileSync(args.dxf)) : generateDrawing(200000);
+const { plate, tools } = plateWithTools();
+const ribbed = ribbedPart();
+const ribbedEdges = wasm.Shape.findSubShapes(ribbed, wasm.TopAbs_ShapeEnum.TopAbs_EDGE).map((_, i) => i);
+const assembly = unwrap(wasm.ShapeFactory.combine(stepParts), "combine");
+
+bench("Converter.convertToStep", () => wasm.Converter.convertToStep(stepParts));
+bench("Converter.convertFromStep", () => wasm.Converter.convertFromStep(stepBytes), deleteResult);
+bench("Converter.convertFromDxf", () => wasm.Converter.convertFromDxf(dxfBytes), deleteResult);
+bench("ShapeFactory.booleanCut", () => wasm.ShapeFactory.booleanCut([plate], tools), deleteResult);
+bench(
+    "ShapeFactory.booleanCutMany",
+    () => wasm.ShapeFactory.booleanCutMany(plate, tools, 8, booleanOptions),
+    deleteResult,
+);
+bench("ShapeFactory.fillet", () => wasm.ShapeFactory.fillet(ribbed, ribbedEdges, 0.8), deleteResult);
+bench(
+    "Mesher.mesh",
+    () => {
+        const mesher = new wasm.Mesher(assembly, 0.1);
+        mesher.mesh().delete();
+        return mesher;
+    },
+    deleteMesh,
+);
+const eye = new wasm.gp_Pnt(0, 0, 0);
+const direction = new wasm.gp_Dir(1, -1, 1);
+const xDirection = new wasm.gp_Dir(1, 1, 0);
+bench("Shape.hlr", () => wasm.Shape.hlr(ribbed, eye, direction, xDirection), deleteResult);
+
+const mb = (bytes) => (bytes / (1 << 20)).toFixed(1);
+console.log(`STEP ${mb(stepBytes.length)} MB, DXF ${mb(dxfBytes.length)} MB, median of ${args.repeat} runs`);
+console.log("operation                      time ms    allocations   allocated MB   peak MB");
+for (const result of results) {
+    console.log(
+        result.name.padEnd(28),
+        result.time.toFixed(1).padStart(10),
+        String(result.count).padStart(14),
+        mb(result.bytes).padStart(14),
+        mb(result.peak).padStart(9),
+    );
+}
+console.log(`wasm memory ${mb(wasm.HEAP8.buffer.byteLength)} MB`);
@@ -0,0 +1,299 @@
+// Part of the Chili3d Project, under the AGPL-3.0 License.
+// See LICENSE file in the project root for full license information.
+
+#include "bvh.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+constexpr uint32_t LEAF_SIZE = 4;
+constexpr int MAX_DEPTH = 64;
+
+template <size_t N>
+void vertexBounds(const float (&vertices)[N], float* min, float* max)
+{
+    for (size_t i = 0; i < N; i++) {
+        min[i % 3] = std::min(min[i % 3], vertices[i]);
+        max[i % 3] = std::max(max[i % 3], vertices[i]);
+    }
+}
+
+template <size_t N>
+void centroid(const float (&vertices)[N], float* out)
+{
+    for (int axis = 0; axis < 3; axis++) {
+        float sum = 0;
+        for (size_t i = axis; i < N; i += 3) {
+            sum += vertices[i];
+        }
+        out[axis] = sum / (N / 3);
+    }
+}
+
+/// @brief The distance along the ray to the box, or infinity when the ray misses it.
+float rayBox(const float* min, const float* max, const float* origin, const float* inverse, float maxDistance)
+{
+    float near = 0, far = maxDistance;
+    for (int axis = 0; axis < 3; axis++) {
+        float t1 = (min[axis] - origin[axis]) * inverse[axis];
+        float t2 = (max[axis] - origin[axis]) * inverse[axis];
+        if (t1 > t2) {
+            std::swap(t1, t2);
+        }
+        near = std::max(near, t1);
+        far = std::min(far, t2);
+        // NaN from 0 * infinity leaves near and far unchanged, the box then counts as hit on that axis
+    }
+    return near <= far ? near : std::numeric_limits<float>::infinity();
+}
+
+float pointBoxSquared(const float* min, const float* max, const float* point)
+{
+    float result = 0;
+    for (int axis = 0; axis < 3; axis++) {
+        float d = std::max({ min[axis] - point[axis], 0.0f, point[axis] - max[axis] });
+        result += d * d;
+    }
+    return result;
+}
+
+/// @brief Möller–Trumbore, the distance along the ray or a negative value when it misses.
+float rayTriangle(const float* v, const float* origin, const float* direction)
+{
+    const float e1[3] = { v[3] - v[0], v[4] - v[1], v[5] - v[2] };
+    const float e2[3] = { v[6] - v[0], v[7] - v[1], v[8] - v[2] };
+    const float p[3] = { direction[1] * e2[2] - direction[2] * e2[1], direction[2] * e2[0] - direction[0] * e2[2],
+        direction[0] * e2[1] - direction[1] * e2[0] };
+    float det = e1[0] * p[0] + e1[1] * p[1] + e1[2] * p[2];
+    if (std::abs(det) < 1e-12f) {
+        return -1;
+    }
+    float inverse = 1.0f / det;
+    const float s[3] = { origin[0] - v[0], origin[1] - v[1], origin[2] - v[2] };
+    float u = (s[0] * p[0] + s[1] * p[1] + s[2] * p[2]) * inverse;
+    if (u < 0 || u > 1) {
+        return -1;
+    }
+    const float q[3] = { s[1] * e1[2] - s[2] * e1[1], s[2] * e1[0] - s[0] * e1[2], s[0] * e1[1] - s[1] * e1[0] };
+    float w = (direction[0] * q[0] + direction[1] * q[1] + direction[2] * q[2]) * inverse;
+    if (w < 0 || u + w > 1) {
+        return -1;
+    }
+    return (e2[0] * q[0] + e2[1] * q[1] + e2[2] * q[2]) * inverse;
+}
+
+float pointSegmentSquared(const float* v, const float* point, float* closest)
+{
+    const float d[3] = { v[3] - v[0], v[4] - v[1], v[5] - v[2] };
+    float lengthSquared = d[0] * d[0] + d[1] * d[1] + d[2] * d[2];
+    float t = 0;
+    if (lengthSquared > 0) {
+        t = ((point[0] - v[0]) * d[0] + (point[1] - v[1]) * d[1] + (point[2] - v[2]) * d[2]) / lengthSquared;
+        t = std::clamp(t, 0.0f, 1.0f);
+    }
+    float result = 0;
+    for (int axis = 0; axis < 3; axis++) {
+        closest[axis] = v[axis] + d[axis] * t;
+        float delta = point[axis] - closest[axis];
+        result += delta * delta;
+    }
+    return result;
+}
+
+void copyVertex(float* out, const float* positions, uint32_t vertex)
+{
+    out[0] = positions[vertex * 3];
+    out[1] = positions[vertex * 3 + 1];
+    out[2] = positions[vertex * 3 + 2];
+}
+
+} // namespace
+
+/// @brief Splits the primitives at the median centroid of the longest axis until a leaf holds at most
+/// LEAF_SIZE of them. Median splits keep the tree balanced, which bounds the stack of the queries.
+template <typename TPrimitive>
+uint32_t MeshBvh::buildNode(std::vector<Node>& nodes, std::vector<TPrimitive>& primitives, uint32_t start, uint32_t end)
+{
+    Node node;
+    std::fill(node.min, node.min + 3, std::numeric_limits<float>::max());
+    std::fill(node.max, node.max + 3, std::numeric_limits<float>::lowest());
+    for (uint32_t i = start; i < end; i++) {
+        vertexBounds(primitives[i].vertices, node.min, node.max);
+    }
+
+    auto index = static_cast<uint32_t>(nodes.size());
+    nodes.push_back(node);
+    if (end - start <= LEAF_SIZE) {
+        nodes[index].start = start;
+        nodes[index].count = end - start;
+        return index;
+    }
+
+    int axis = 0;
+    for (int i = 1; i < 3; i++) {
+        if (node.max[i] - node.min[i] > node.max[axis] - node.min[axis]) {
+            axis = i;
+        }
+    }
+    uint32_t middle = start + (end - start) / 2;
+    std::nth_element(primitives.begin() + start, primitives.begin() + middle, primitives.begin() + end,
+        [axis](const TPrimitive& a, const TPrimitive& b) { return a.center[axis] < b.center[axis]; });
+
+    // the left child follows its parent, the right one comes after the whole left subtree
+    buildNode(nodes, primitives, start, middle);
+    uint32_t right = buildNode(nodes, primitives, middle, end);
+    nodes[index].start = right;
+    nodes[index].count = 0;
+    return index;
+}
+
+void MeshBvh::buildFaces(const float* positions, const uint32_t* indices, const uint32_t* group, size_t faceCount)
+{
+    triangles.clear();
+    for (size_t face = 0; face < faceCount; face++) {
+        for (uint32_t i = group[face * 2]; i + 2 < group[face * 2] + group[face * 2 + 1]; i += 3) {
+            Triangle triangle;
+            for (int k = 0; k < 3; k++) {
+                copyVertex(triangle.vertices + k * 3, positions, indices[i + k]);
+            }
+            centroid(triangle.vertices, triangle.center);
+            triangle.index = static_cast<uint32_t>(face);
+            triangles.push_back(triangle);
+        }
+    }
+
+    faceNodes.clear();
+    if (!triangles.empty()) {
+        faceNodes.reserve(2 * triangles.size() / LEAF_SIZE + 1);
+        buildNode(faceNodes, triangles, 0, static_cast<uint32_t>(triangles.size()));
+    }
+}
+
+void MeshBvh::buildEdges(const float* positions, const uint32_t* indices, const uint32_t* group, size_t edgeCount)
+{
+    segments.clear();
+    for (size_t edge = 0; edge < edgeCount; edge++) {
+        for (uint32_t i = group[edge * 2]; i + 1 < group[edge * 2] + group[edge * 2 + 1]; i += 2) {
+            Segment segment;
+            copyVertex(segment.vertices, positions, indices ? indices[i] : i);
+            copyVertex(segment.vertices + 3, positions, indices ? indices[i + 1] : i + 1);
+            centroid(segment.vertices, segment.center);
+            segment.index = static_cast<uint32_t>(edge);
+            segments.push_back(segment);
+        }
+    }
+
+    edgeNodes.clear();
+    if (!segments.empty()) {
+        edgeNodes.reserve(2 * segments.size() / LEAF_SIZE + 1);
+        buildNode(edgeNodes, segments, 0, static_cast<uint32_t>(segments.size()));
+    }
+}
+
+std::optional<BvhHit> MeshBvh::raycast(const float* origin, const float* direction, float maxDistance) const
+{
+    float length = std::sqrt(direction[0] * direction[0] + direction[1] * direction[1] + direction[2] * direction[2]);
+    if (faceNodes.empty() || length == 0) {
+        return std::nullopt;
+    }
+    const float unit[3] = { direction[0] / length, direction[1] / length, direction[2] / length };
+    const float inverse[3] = { 1.0f / unit[0], 1.0f / unit[1], 1.0f / unit[2] };
+    constexpr float MISS = std::numeric_limits<float>::infinity();
+
+    float best = maxDistance;
+    const Triangle* hit = nullptr;
+    uint32_t stack[MAX_DEPTH];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0) {
+        uint32_t index = stack[--top];
+        const Node& node = faceNodes[index];
+        if (rayBox(node.min, node.max, origin, inverse, best) == MISS) {
+            continue;
+        }
+        if (node.count > 0) {
+            for (uint32_t i = node.start; i < node.start + node.count; i++) {
+                float t = rayTriangle(triangles[i].vertices, origin, unit);
+                if (t >= 0 && t < best) {
+                    best = t;
+                    hit = &triangles[i];
+                }
+            }
+            continue;
+        }
+
+        // visit the nearer child first, it usually shortens best before the other one is tested
+        uint32_t near = index + 1, far = node.start;
+        float nearDistance = rayBox(faceNodes[near].min, faceNodes[near].max, origin, inverse, best);
+        float farDistance = rayBox(faceNodes[far].min, faceNodes[far].max, origin, inverse, best);
+        if (farDistance < nearDistance) {
+            std::swap(near, far);
+            std::swap(nearDistance, farDistance);
+        }
+        if (farDistance != MISS && top < MAX_DEPTH) {
+            stack[top++] = far;
+        }
+        if (nearDistance != MISS && top < MAX_DEPTH) {
+            stack[top++] = near;
+        }
+    }
+
+    if (hit == nullptr) {
+        return std::nullopt;
+    }
+    return BvhHit { hit->index, best,
+        { origin[0] + unit[0] * best, origin[1] + unit[1] * best, origin[2] + unit[2] * best } };
+}
+
+std::optional<BvhHit> MeshBvh::nearestEdge(const float* point, float maxDistance) const
+{
+    if (edgeNodes.empty()) {
+        return std::nullopt;
+    }
+
+    float best = maxDistance * maxDistance;
+    std::optional<BvhHit> result;
+    uint32_t stack[MAX_DEPTH];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0) {
+        uint32_t index = stack[--top];
+        const Node& node = edgeNodes[index];
+        if (pointBoxSquared(node.min, node.max, point) > best) {
+            continue;
+        }
+        if (node.count > 0) {
+            for (uint32_t i = node.start; i < node.start + node.count; i++) {
+                float closest[3];
+                float distance = pointSegmentSquared(segments[i].vertices, point, closest);
+                if (distance <= best) {
+                    best = distance;
+                    result = BvhHit { segments[i].index, 0, { closest[0], closest[1], closest[2] } };
+                }
+            }
+            continue;
+        }
+
+        uint32_t near = index + 1, far = node.start;
+        float nearDistance = pointBoxSquared(edgeNodes[near].min, edgeNodes[near].max, point);
+        float farDistance = pointBoxSquared(edgeNodes[far].min, edgeNodes[far].max, point);
+        if (farDistance < nearDistance) {
+            std::swap(near, far);
+            std::swap(nearDistance, farDistance);
+        }
+        if (farDistance <= best && top < MAX_DEPTH) {
+            stack[top++] = far;
+        }
+        if (nearDistance <= best && top < MAX_DEPTH) {
+            stack[top++] = near;
+        }
+    }
+
+    if (result) {
+        result->distance = std::sqrt(best);
+    }
+    return result;
+}
@@ -0,0 +1,75 @@
+// Part of the Chili3d Project, under the AGPL-3.0 License.
+// See LICENSE file in the project root for full license information.
+
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+/// @brief The closest primitive of a query, index is the face or edge slot of the mesh groups.
+struct BvhHit {
+    uint32_t index;
+    float distance;
+    float point[3];
+};
+
+/// @brief Flat bounding volume hierarchies over the triangles and edge segments of a mesh. The nodes are
+/// stored depth first, the left child of an inner node follows it and the primitives of a leaf are
+/// contiguous, so a query walks the arrays mostly forward.
+class MeshBvh {
+public:
+    /// @brief Indexes the triangles of faces, group holds start and count of every face in indices.
+    void buildFaces(const float* positions, const uint32_t* indices, const uint32_t* group, size_t faceCount);
+
+    /// @brief Indexes the segments of edges. With indices the group counts indices, which come in pairs,
+    /// otherwise it counts points in positions and every two points form a segment.
+    void buildEdges(const float* positions, const uint32_t* indices, const uint32_t* group, size_t edgeCount);
+
+    /// @brief The first triangle along the ray, the direction does not need to be normalized.
+    std::optional<BvhHit> raycast(const float* origin, const float* direction, float maxDistance) const;
+
+    /// @brief The closest segment within maxDistance of the point.
+    std::optional<BvhHit> nearestEdge(const float* point, float maxDistance) const;
+
+    size_t triangleCount() const
+    {
+        return triangles.size();
+    }
+
+    size_t segmentCount() const
+    {
+        return segments.size();
+    }
+
+private:
+    struct Node {
+        float min[3];
+        float max[3];
+        /// @brief The first primitive of a leaf, or the right child of an inner node.
+        uint32_t start;
+        /// @brief 0 for an inner node.
+        uint32_t count;
+    };
+
+    struct Triangle {
+        float vertices[9];
+        /// @brief The centroid, the build splits on it.
+        float center[3];
+        uint32_t index;
+    };
+
+    struct Segment {
+        float vertices[6];
+        float center[3];
+        uint32_t index;
+    };
+
+    std::vector<Node> faceNodes;
+    std::vector<Triangle> triangles;
+    std::vector<Node> edgeNodes;
+    std::vector<Segment> segments;
+
+    template <typename TPrimitive>
+    static uint32_t buildNode(std::vector<Node>& nodes, std::vector<TPrimitive>& primitives, uint32_t start, uint32_t end);
+};
@@ -4,23 +4,29 @@
 #include <emscripten/bind.h>
 #include <emscripten/val.h>
 
+#include <BRepAdaptor_Curve.hxx>
 #include <BRepBuilderAPI_MakeSolid.hxx>
 #include <BRepBuilderAPI_Sewing.hxx>
 #include <BRepMesh_IncrementalMesh.hxx>
 #include <BRepPrimAPI_MakeBox.hxx>
 #include <BRepTools.hxx>
 #include <BRep_Builder.hxx>
+#include <BRep_Tool.hxx>
+#include <BinTools.hxx>
 #include <IGESCAFControl_Reader.hxx>
 #include <IGESControl_Writer.hxx>
 #include <Quantity_Color.hxx>
 #include <STEPCAFControl_Reader.hxx>
+#include <STEPConstruct_Styles.hxx>
 #include <STEPControl_Writer.hxx>
-#include <StlAPI_Reader.hxx>
+#include <RWStl_Reader.hxx>
+#include <Standard_ReadLineBuffer.hxx>
 #include <StlAPI_Writer.hxx>
 #include <TDF_ChildIterator.hxx>
 #include <TDF_Label.hxx>
 #include <TDataStd_Name.hxx>
 #include <TDocStd_Document.hxx>
+#include <TopLoc_Location.hxx>
 #include <TopoDS_Iterator.hxx>
 #include <TopoDS_Shape.hxx>
 #include <XCAFDoc_ColorTool.hxx>
@@ -29,33 +35,127 @@
 #include <XCAFApp_Application.hxx>
 #include <TDF_LabelSequence.hxx>
 #include <TopTools_IndexedMapOfShape.hxx>
+#include <TopExp.hxx>
 #include <TopExp_Explorer.hxx>
 #include <TopAbs_ShapeEnum.hxx>
 #include <RWStepVisual_RWStyledItem.hxx>
 #include <StepVisual_StyledItem.hxx>
 #include <StepVisual_Colour.hxx>
 #include <StepVisual_ColourRgb.hxx>
+#include <StepBasic_Product.hxx>
+#include <StepBasic_ProductDefinition.hxx>
+#include <StepBasic_ProductDefinitionFormation.hxx>
 #include <TCollection_HAsciiString.hxx>
+#include <TransferBRep.hxx>
+#include <Transfer_TransientProcess.hxx>
+#include <XSControl_TransferReader.hxx>
+#include <XSControl_WorkSession.hxx>
 #include <Interface_Static.hxx>
+#include <BRepBuilderAPI_MakeEdge.hxx>
+#include <BRepBuilderAPI_MakePolygon.hxx>
+#include <BRepBuilderAPI_MakeFace.hxx>
+#include <BRepBuilderAPI_MakeVertex.hxx>
+#include <BRepBuilderAPI_MakeWire.hxx>
+#include <BRepBuilderAPI_GTransform.hxx>
+#include <BRepBuilderAPI_Transform.hxx>
+#include <GeomAbs_CurveType.hxx>
+#include <Geom_Circle.hxx>
+#include <OSD_Parallel.hxx>
+#include <Precision.hxx>
+#include <gp.hxx>
+#include <gp_GTrsf.hxx>
+#include <array>
+#include <atomic>
+#include <fstream>
 #include <sstream>
-#include <map>
+#include <memory>
+#include <unordered_map>
 #include <vector>
 #include <algorithm>
 #include <cmath>
 
+#include "dxf.hpp"
+#include "progress.hpp"
 #include "shared.hpp"
+#include "trace.hpp"
 #include "utils.hpp"
 
 using namespace emscripten;
 
-class VectorBuffer : public std::streambuf {
+/// @brief Relative to the bounding box like the LINE_DEFLECTION of the TS mesher.
+const double DXF_LINE_DEFLECTION = 0.005;
+
+/// @brief Collects the nodes and triangles of an STL stream, binary or ASCII.
+class StlMemoryReader : public RWStl_Reader {
 public:
-    VectorBuffer(const std::vector<uint8_t>& v)
+    std::vector<gp_XYZ> nodes;
+    std::vector<std::array<int, 3>> triangles;
+
+    bool read(std::istream& stream)
     {
-        setg((char*)v.data(), (char*)v.data(), (char*)(v.data() + v.size()));
+        stream.seekg(0, std::ios::end);
+        std::streampos end = stream.tellg();
+        stream.seekg(0, std::ios::beg);
+
+        bool isAscii = IsAscii(stream, true);
+        Standard_ReadLineBuffer buffer(1024);
+        while (stream.good()) {
+            bool isOk = isAscii ? ReadAscii(stream, buffer, end, Message_ProgressRange()) : ReadBinary(stream, Message_ProgressRange());
+            if (!isOk) {
+                break;
+            }
+            stream >> std::ws;
+        }
+        return !triangles.empty();
+    }
+
+    Standard_Integer AddNode(const gp_XYZ& point) override
+    {
+        nodes.push_back(point);
+        return static_cast<Standard_Integer>(nodes.size() - 1);
+    }
+
+    void AddTriangle(Standard_Integer n1, Standard_Integer n2, Standard_Integer n3) override
+    {
+        triangles.push_back({ n1, n2, n3 });
     }
 };
 
+/// @brief A uniquely named MEMFS file for readers that only accept a path, removed when it goes out of scope.
+class TempFile {
+    static std::atomic<int> counter;
+
+public:
+    std::string path;
+
+    TempFile(const std::string& extension)
+        : path("/tmp/chili-import-" + std::to_string(counter++) + extension)
+    {
+    }
+
+    ~TempFile()
+    {
+        std::remove(path.c_str());
+    }
+
+    /// @brief Copies the JS buffer in chunks so the whole file is never held twice in the heap.
+    bool write(const Uint8Array& buffer)
+    {
+        static const size_t CHUNK_SIZE = 1 << 20;
+        std::ofstream file(path, std::ios::binary);
+        std::vector<uint8_t> chunk(CHUNK_SIZE);
+        size_t length = buffer["length"].as<size_t>();
+        for (size_t offset = 0; offset < length; offset += CHUNK_SIZE) {
+            size_t count = std::min(CHUNK_SIZE, length - offset);
+            val(typed_memory_view(count, chunk.data())).call<void>("set", buffer.call<val>("subarray", offset, offset + count));
+            file.write((char*)chunk.data(), count);
+        }
+        return file.good();
+    }
+};
+
+std::atomic<int> TempFile::counter { 0 };
+
 EMSCRIPTEN_DECLARE_VAL_TYPE(ShapeNodeArray)
 
 struct ShapeNode {
@@ -63,6 +163,12 @@ struct ShapeNode {
     std::optional<std::string> color;
     std::vector<ShapeNode> children;
     std::string name;
+    /// @brief Nodes with the same id are instances of one prototype, -1 for nodes without a shape.
+    int prototypeId = -1;
+    /// @brief The shape without its location, meshing it once serves every instance.
+    std::optional<TopoDS_Shape> prototype = std::nullopt;
+    /// @brief Places the prototype, shape is prototype moved by location.
+    TopLoc_Location location = TopLoc_Location();
 
     ShapeNodeArray getChildren() const
     {
@@ -273,13 +379,59 @@ ShapeNode parseRootLabelToNode(const Handle(XCAFDoc_ShapeTool) & shapeTool, cons
     return node;
 }
 
+/// @brief XCAF references resolve to located copies of one TShape, so the shapes of the nodes are split
+/// into a prototype without location, keyed by TShape and orientation, and the location of the instance.
+void assignPrototypes(ShapeNode& node, std::unordered_map<TopoDS_Shape, int>& prototypes)
+{
+    if (node.shape.has_value() && !node.shape->IsNull()) {
+        auto prototype = node.shape->Located(TopLoc_Location());
+        node.prototypeId = prototypes.try_emplace(prototype, static_cast<int>(prototypes.size())).first->second;
+        node.prototype = prototype;
+        node.location = node.shape->Location();
+    }
+    for (auto& child : node.children) {
+        assignPrototypes(child, prototypes);
+    }
+}
+
 static ShapeNode parseNodeFromDocument(Handle(TDocStd_Document) document)
 {
+    TRACE_SCOPE("parseNodeFromDocument");
     TDF_Label mainLabel = document->Main();
     Handle(XCAFDoc_ShapeTool) shapeTool = XCAFDoc_DocumentTool::ShapeTool(mainLabel);
     Handle(XCAFDoc_ColorTool) colorTool = XCAFDoc_DocumentTool::ColorTool(mainLabel);
 
-    return parseRootLabelToNode(shapeTool, colorTool);
+    auto node = parseRootLabelToNode(shapeTool, colorTool);
+    std::unordered_map<TopoDS_Shape, int> prototypes;
+    assignPrototypes(node, prototypes);
+    return node;
+}
+
+/// @brief Copies the JS bytes into the wasm heap.
+static std::vector<uint8_t> copyInput(const Uint8Array& buffer)
+{
+    TRACE_SCOPE("copyInput");
+    TRACE_COUNT("inputBytes", buffer["length"].as<double>());
+    return convertJSArrayToNumberVector<uint8_t>(buffer);
+}
+
+/// @brief The share of the progress taken by parsing a STEP file, the transfer takes the rest.
+static constexpr double STEP_READ_SHARE = 0.1;
+
+/// @brief The STEP parser takes no progress range, so the read only reports the stage "Read" as it starts
+/// and once it ends, and cannot be cancelled.
+static bool readStep(STEPCAFControl_Reader& reader, const Uint8Array& buffer, const Message_ProgressRange& range)
+{
+    std::vector<uint8_t> input = copyInput(buffer);
+    VectorBuffer vectorBuffer(input);
+    std::istream iss(&vectorBuffer);
+
+    Message_ProgressScope scope(range, "Read", 1);
+    scope.Show();
+    TRACE_SCOPE("STEPCAFControl_Reader::ReadStream");
+    bool isDone = reader.ReadStream("stp", iss) == IFSelect_RetDone;
+    scope.Next();
+    return isDone;
 }
 
 class Converter {
@@ -294,13 +446,33 @@ private:
         return sewing.SewedShape();
     }
 
-    static void writeBufferToFile(const std::string& fileName, const Uint8Array& buffer)
+    /// @brief Builds one planar face per triangle and sews them, the way StlAPI_Reader does.
+    static TopoDS_Shape shapeFromTriangles(const StlMemoryReader& reader)
     {
-        std::vector<uint8_t> input = convertJSArrayToNumberVector<uint8_t>(buffer);
-        std::ofstream dummyFile;
-        dummyFile.open(fileName, std::ios::binary);
-        dummyFile.write((char*)input.data(), input.size());
-        dummyFile.close();
+        BRep_Builder builder;
+        TopoDS_Compound compound;
+        builder.MakeCompound(compound);
+        for (const auto& triangle : reader.triangles) {
+            gp_Pnt p1(reader.nodes[triangle[0]]), p2(reader.nodes[triangle[1]]), p3(reader.nodes[triangle[2]]);
+            if (p1.IsEqual(p2, 0.0) || p1.IsEqual(p3, 0.0)) {
+                continue;
+            }
+            TopoDS_Wire wire = BRepBuilderAPI_MakePolygon(BRepBuilderAPI_MakeVertex(p1), BRepBuilderAPI_MakeVertex(p2),
+                BRepBuilderAPI_MakeVertex(p3), Standard_True);
+            if (wire.IsNull()) {
+                continue;
+            }
+            TopoDS_Face face = BRepBuilderAPI_MakeFace(wire);
+            if (!face.IsNull()) {
+                builder.Add(compound, face);
+            }
+        }
+
+        BRepBuilderAPI_Sewing sewing(1.0e-06, Standard_True);
+        sewing.Load(compound);
+        sewing.Perform();
+        TopoDS_Shape shape = sewing.SewedShape();
+        return shape.IsNull() ? TopoDS_Shape(compound) : shape;
     }
 
 public:
@@ -320,48 +492,86 @@ public:
         return output;
     }
 
-    static std::optional<ShapeNode> convertFromStep(const Uint8Array& buffer)
+    /// @brief The BinTools binary BRep, a fraction of the text format in size and parse time.
+    static Uint8Array convertToBinBrep(const TopoDS_Shape& input, bool withTriangles)
+    {
+        std::ostringstream oss(std::ios::binary);
+        BinTools::Write(input, oss, withTriangles, false, BinTools_FormatVersion_CURRENT);
+        auto bytes = oss.str();
+        return Uint8Array(val(typed_memory_view(bytes.size(), bytes.data())).call<val>("slice"));
+    }
+
+    static TopoDS_Shape convertFromBinBrep(const Uint8Array& buffer)
     {
         std::vector<uint8_t> input = convertJSArrayToNumberVector<uint8_t>(buffer);
         VectorBuffer vectorBuffer(input);
         std::istream iss(&vectorBuffer);
+        TopoDS_Shape output;
+        BinTools::Read(output, iss);
+        return output;
+    }
+
+    static std::optional<ShapeNode> convertFromStep(const Uint8Array& buffer)
+    {
+        return convertFromStepWithProgress(buffer, val::undefined());
+    }
 
+    /// @brief onProgress follows JsProgressIndicator, a cancelled transfer returns nothing.
+    static std::optional<ShapeNode> convertFromStepWithProgress(const Uint8Array& buffer, const val& onProgress)
+    {
+        TRACE_SCOPE("convertFromStep");
         STEPCAFControl_Reader cafReader;
         cafReader.SetColorMode(true);
         cafReader.SetNameMode(true);
-        IFSelect_ReturnStatus readStatus = cafReader.ReadStream("stp", iss);
-
-        if (readStatus != IFSelect_RetDone) {
+        Handle(JsProgressIndicator) progress = new JsProgressIndicator(onProgress);
+        Message_ProgressScope scope(progress->Start(), "STEP", 1);
+        if (!readStep(cafReader, buffer, scope.Next(STEP_READ_SHARE))) {
             return std::nullopt;
         }
 
         Handle(TDocStd_Document) document = new TDocStd_Document("bincaf");
-        if (!cafReader.Transfer(document)) {
-            return std::nullopt;
+        {
+            TRACE_SCOPE("STEPCAFControl_Reader::Transfer");
+            if (!cafReader.Transfer(document, scope.Next(1 - STEP_READ_SHARE)) || progress->isCancelled()) {
+                return std::nullopt;
+            }
         }
 
         return parseNodeFromDocument(document);
     }
 
+    /// @brief IGESCAFControl_Reader has no stream reader, so it reads from a unique temporary file.
     static std::optional<ShapeNode> convertFromIges(const Uint8Array& buffer)
     {
-        std::string dummyFileName = "temp.igs";
-        writeBufferToFile(dummyFileName, buffer);
+        return convertFromIgesWithProgress(buffer, val::undefined());
+    }
+
+    static std::optional<ShapeNode> convertFromIgesWithProgress(const Uint8Array& buffer, const val& onProgress)
+    {
+        TRACE_SCOPE("convertFromIges");
+        TempFile file(".igs");
+        if (!file.write(buffer)) {
+            return std::nullopt;
+        }
 
         IGESCAFControl_Reader igesCafReader;
         igesCafReader.SetColorMode(true);
         igesCafReader.SetNameMode(true);
-        if (igesCafReader.ReadFile(dummyFileName.c_str()) != IFSelect_RetDone) {
-            std::remove(dummyFileName.c_str());
-            return std::nullopt;
+        {
+            TRACE_SCOPE("IGESCAFControl_Reader::ReadFile");
+            if (igesCafReader.ReadFile(file.path.c_str()) != IFSelect_RetDone) {
+                return std::nullopt;
+            }
         }
 
+        Handle(JsProgressIndicator) progress = new JsProgressIndicator(onProgress);
         Handle(TDocStd_Document) document = new TDocStd_Document("bincaf");
-        if (!igesCafReader.Transfer(document)) {
-            std::remove(dummyFileName.c_str());
-            return std::nullopt;
+        {
+            TRACE_SCOPE("IGESCAFControl_Reader::Transfer");
+            if (!igesCafReader.Transfer(document, progress->Start()) || progress->isCancelled()) {
+                return std::nullopt;
+            }
         }
-        std::remove(dummyFileName.c_str());
         return parseNodeFromDocument(document);
     }
 
@@ -392,336 +602,355 @@ public:
 
     static std::optional<ShapeNode> convertFromStl(const Uint8Array& buffer)
     {
-        std::string dummyFileName = "temp.stl";
-        writeBufferToFile(dummyFileName, buffer);
+        std::vector<uint8_t> input = convertJSArrayToNumberVector<uint8_t>(buffer);
+        VectorBuffer vectorBuffer(input);
+        std::istream iss(&vectorBuffer);
 
-        StlAPI_Reader stlReader;
-        TopoDS_Shape shape;
-        if (!stlReader.Read(shape, dummyFileName.c_str())) {
+        StlMemoryReader stlReader;
+        if (!stlReader.read(iss)) {
             return std::nullopt;
         }
+        TopoDS_Shape shape = shapeFromTriangles(stlReader);
 
         ShapeNode node = { .shape = shape, .color = std::nullopt, .children = {}, .name = "STL Shape" };
 
         return node;
     }
 
-    struct DxfEntity {
-        std::string type;
-        std::map<int, std::string> groupCodes;
-        std::string layer;
-        std::string color;
-        
-        DxfEntity(const std::string& entityType) : type(entityType) {}
-    };
-
-    struct DxfLayer {
-        std::string name;
-        std::string color;
-        bool isVisible = true;
-        bool isLocked = false;
-    };
-    
-    struct DxfBlock {
-        std::string name;
-        std::vector<DxfEntity> entities;
-        std::map<int, std::string> groupCodes;
-        
-        DxfBlock(const std::string& blockName) : name(blockName) {}
-    };
-
-    static std::vector<DxfEntity> parseDxfEntities(const std::string& content)
+    static TopoDS_Shape createLineFromDxf(const DxfDocument& document, const DxfEntity& entity)
     {
-        std::vector<DxfEntity> entities;
-        std::istringstream stream(content);
-        std::string line;
-        DxfEntity* currentEntity = nullptr;
-        std::string currentLayer = "0"; // Default layer
-        
-        while (std::getline(stream, line)) {
-            // Trim whitespace
-            line.erase(0, line.find_first_not_of(" \t\r\n"));
-            line.erase(line.find_last_not_of(" \t\r\n") + 1);
-            
-            if (line.empty()) continue;
-            
-            // Check if this is a group code (integer) or value
-            if (std::isdigit(line[0]) || (line[0] == '-' && line.length() > 1 && std::isdigit(line[1]))) {
-                int groupCode = std::stoi(line);
-                
-                if (std::getline(stream, line)) {
-                    line.erase(0, line.find_first_not_of(" \t\r\n"));
-                    line.erase(line.find_last_not_of(" \t\r\n") + 1);
-                    
-                    if (groupCode == 0) {
-                        // New entity type or section
-                        if (currentEntity) {
-                            currentEntity->layer = currentLayer;
-                            entities.push_back(*currentEntity);
-                            delete currentEntity;
-                        }
-                        currentEntity = new DxfEntity(line);
-                    } else if (currentEntity) {
-                        currentEntity->groupCodes[groupCode] = line;
-                        
-                        // Store layer information
-                        if (groupCode == 8) {
-                            currentLayer = line;
-                        }
-                        
-                        // Store color information
-                        if (groupCode == 62) {
-                            currentEntity->color = line;
-                        }
-                    }
-                }
-            }
-        }
-        
-        if (currentEntity) {
-            currentEntity->layer = currentLayer;
-            entities.push_back(*currentEntity);
-            delete currentEntity;
+        auto x1 = document.number(entity, 10), y1 = document.number(entity, 20);
+        auto x2 = document.number(entity, 11), y2 = document.number(entity, 21);
+        if (!x1 || !y1 || !x2 || !y2) {
+            return TopoDS_Shape();
         }
-        
-        return entities;
-    }
 
-    static TopoDS_Shape createLineFromDxf(const DxfEntity& entity)
-    {
-        auto itX1 = entity.groupCodes.find(10);
-        auto itY1 = entity.groupCodes.find(20);
-        auto itX2 = entity.groupCodes.find(11);
-        auto itY2 = entity.groupCodes.find(21);
-        
-        if (itX1 != entity.groupCodes.end() && itY1 != entity.groupCodes.end() &&
-            itX2 != entity.groupCodes.end() && itY2 != entity.groupCodes.end()) {
-            
-            double x1 = std::stod(itX1->second);
-            double y1 = std::stod(itY1->second);
-            double x2 = std::stod(itX2->second);
-            double y2 = std::stod(itY2->second);
-            
-            gp_Pnt p1(x1, y1, 0);
-            gp_Pnt p2(x2, y2, 0);
-            
-            BRepBuilderAPI_MakeEdge edge(p1, p2);
-            return edge.Edge();
+        gp_Pnt p1(*x1, *y1, document.number(entity, 30).value_or(0));
+        gp_Pnt p2(*x2, *y2, document.number(entity, 31).value_or(0));
+        if (p1.IsEqual(p2, Precision::Confusion())) {
+            return TopoDS_Shape();
         }
-        
-        return TopoDS_Shape();
+
+        BRepBuilderAPI_MakeEdge edge(p1, p2);
+        return edge.IsDone() ? TopoDS_Shape(edge.Edge()) : TopoDS_Shape();
     }
 
-    static TopoDS_Shape createCircleFromDxf(const DxfEntity& entity)
+    static TopoDS_Shape createCircleFromDxf(const DxfDocument& document, const DxfEntity& entity)
     {
-        auto itX = entity.groupCodes.find(10);
-        auto itY = entity.groupCodes.find(20);
-        auto itR = entity.groupCodes.find(40);
-        
-        if (itX != entity.groupCodes.end() && itY != entity.groupCodes.end() && itR != entity.groupCodes.end()) {
-            double centerX = std::stod(itX->second);
-            double centerY = std::stod(itY->second);
-            double radius = std::stod(itR->second);
-            
-            gp_Pnt center(centerX, centerY, 0);
-            gp_Dir normal(0, 0, 1);
-            gp_Ax2 axis(center, normal);
-            
-            Handle(Geom_Circle) circle = new Geom_Circle(axis, radius);
-            BRepBuilderAPI_MakeEdge edge(circle, 0, 2 * M_PI);
-            return edge.Edge();
+        auto x = document.number(entity, 10), y = document.number(entity, 20), radius = document.number(entity, 40);
+        if (!x || !y || !radius || *radius <= 0) {
+            return TopoDS_Shape();
         }
-        
-        return TopoDS_Shape();
+
+        gp_Ax2 axis(gp_Pnt(*x, *y, document.number(entity, 30).value_or(0)), gp_Dir(0, 0, 1));
+        Handle(Geom_Circle) circle = new Geom_Circle(axis, *radius);
+        BRepBuilderAPI_MakeEdge edge(circle, 0, 2 * M_PI);
+        return edge.IsDone() ? TopoDS_Shape(edge.Edge()) : TopoDS_Shape();
     }
 
-    static TopoDS_Shape createArcFromDxf(const DxfEntity& entity)
+    static TopoDS_Shape createArcFromDxf(const DxfDocument& document, const DxfEntity& entity)
     {
-        auto itX = entity.groupCodes.find(10);
-        auto itY = entity.groupCodes.find(20);
-        auto itR = entity.groupCodes.find(40);
-        auto itStartAngle = entity.groupCodes.find(50);
-        auto itEndAngle = entity.groupCodes.find(51);
-        
-        if (itX != entity.groupCodes.end() && itY != entity.groupCodes.end() &&
-            itR != entity.groupCodes.end() && itStartAngle != entity.groupCodes.end() &&
-            itEndAngle != entity.groupCodes.end()) {
-            
-            double centerX = std::stod(itX->second);
-            double centerY = std::stod(itY->second);
-            double radius = std::stod(itR->second);
-            double startAngle = std::stod(itStartAngle->second) * M_PI / 180.0;
-            double endAngle = std::stod(itEndAngle->second) * M_PI / 180.0;
-            
-            gp_Pnt center(centerX, centerY, 0);
-            gp_Dir normal(0, 0, 1);
-            gp_Ax2 axis(center, normal);
-            
-            Handle(Geom_Circle) circle = new Geom_Circle(axis, radius);
-            BRepBuilderAPI_MakeEdge edge(circle, startAngle, endAngle);
-            return edge.Edge();
+        auto x = document.number(entity, 10), y = document.number(entity, 20), radius = document.number(entity, 40);
+        auto startAngle = document.number(entity, 50), endAngle = document.number(entity, 51);
+        if (!x || !y || !radius || *radius <= 0 || !startAngle || !endAngle) {
+            return TopoDS_Shape();
         }
-        
-        return TopoDS_Shape();
+
+        gp_Ax2 axis(gp_Pnt(*x, *y, document.number(entity, 30).value_or(0)), gp_Dir(0, 0, 1));
+        Handle(Geom_Circle) circle = new Geom_Circle(axis, *radius);
+        BRepBuilderAPI_MakeEdge edge(circle, *startAngle * M_PI / 180.0, *endAngle * M_PI / 180.0);
+        return edge.IsDone() ? TopoDS_Shape(edge.Edge()) : TopoDS_Shape();
     }
 
-    static TopoDS_Shape createPolylineFromDxf(const DxfEntity& entity)
+    static TopoDS_Shape createPolylineFromDxf(const DxfDocument& document, const DxfEntity& entity)
     {
+        int flags = document.integer(entity, 70, 0);
+        // Bit 3 marks a 3D POLYLINE, 2D ones lie at the elevation of their header
+        bool is3D = entity.type == "POLYLINE" && (flags & 8);
+        double elevation = document.number(entity, entity.type == "POLYLINE" ? 30 : 38).value_or(0);
+
         std::vector<gp_Pnt> points;
-        
-        // Extract all vertex coordinates (group codes 10, 20, 30)
-        // For 3D polylines, also extract Z coordinates (group code 30)
-        bool is3D = (entity.type == "POLYLINE" && entity.groupCodes.find(70) != entity.groupCodes.end() &&
-                     (std::stoi(entity.groupCodes.at(70)) & 8)); // Bit 3 indicates 3D polyline
-        
-        // Collect all vertices
-        std::vector<int> xCodes, yCodes, zCodes;
-        for (const auto& pair : entity.groupCodes) {
-            if (pair.first == 10) xCodes.push_back(std::stoi(pair.second));
-            else if (pair.first == 20) yCodes.push_back(std::stoi(pair.second));
-            else if (pair.first == 30) zCodes.push_back(std::stoi(pair.second));
-        }
-        
-        // Build points from coordinates
-        size_t numPoints = std::min({xCodes.size(), yCodes.size(), zCodes.size()});
-        if (is3D) {
-            for (size_t i = 0; i < numPoints; i++) {
-                points.push_back(gp_Pnt(xCodes[i], yCodes[i], zCodes[i]));
-            }
-        } else {
-            for (size_t i = 0; i < std::min(xCodes.size(), yCodes.size()); i++) {
-                points.push_back(gp_Pnt(xCodes[i], yCodes[i], 0));
+        auto coordinates = document.vertices(entity);
+        for (size_t i = 0; i + 2 < coordinates.size(); i += 3) {
+            gp_Pnt point(coordinates[i], coordinates[i + 1], is3D ? coordinates[i + 2] : elevation);
+            if (points.empty() || !points.back().IsEqual(point, Precision::Confusion())) {
+                points.push_back(point);
             }
         }
-        
-        if (points.size() >= 2) {
-            BRepBuilderAPI_MakeWire wireBuilder;
-            for (size_t i = 0; i < points.size() - 1; i++) {
-                BRepBuilderAPI_MakeEdge edge(points[i], points[i + 1]);
-                wireBuilder.Add(edge.Edge());
-            }
-            
-            if (entity.type == "LWPOLYLINE" && points.size() > 2) {
-                // Check if polyline is closed (group code 70, bit 0)
-                bool isClosed = false;
-                auto itFlags = entity.groupCodes.find(70);
-                if (itFlags != entity.groupCodes.end()) {
-                    isClosed = (std::stoi(itFlags->second) & 1);
-                }
-                
-                if (isClosed) {
-                    BRepBuilderAPI_MakeEdge edge(points.back(), points.front());
-                    wireBuilder.Add(edge.Edge());
-                }
+        // Bit 0 closes the polyline
+        if ((flags & 1) && points.size() > 2 && !points.back().IsEqual(points.front(), Precision::Confusion())) {
+            points.push_back(points.front());
+        }
+        if (points.size() < 2) {
+            return TopoDS_Shape();
+        }
+
+        BRepBuilderAPI_MakeWire wireBuilder;
+        for (size_t i = 0; i < points.size() - 1; i++) {
+            BRepBuilderAPI_MakeEdge edge(points[i], points[i + 1]);
+            if (!edge.IsDone()) {
+                return TopoDS_Shape();
             }
-            
-            return wireBuilder.Wire();
+            wireBuilder.Add(edge.Edge());
         }
-        
-        return TopoDS_Shape();
+        return wireBuilder.IsDone() ? TopoDS_Shape(wireBuilder.Wire()) : TopoDS_Shape();
     }
 
-    static TopoDS_Shape create3DFaceFromDxf(const DxfEntity& entity)
+    static TopoDS_Shape create3DFaceFromDxf(const DxfDocument& document, const DxfEntity& entity)
     {
         std::vector<gp_Pnt> points;
-        
-        // Extract corner coordinates (group codes 10, 20, 30 for first corner, 11, 21, 31 for second, etc.)
+
+        // Corner i has the group codes 10 + i, 20 + i and 30 + i, the fourth repeats the third on triangles
         for (int i = 0; i < 4; i++) {
-            int xCode = 10 + i;
-            int yCode = 20 + i;
-            int zCode = 30 + i;
-            
-            auto itX = entity.groupCodes.find(xCode);
-            auto itY = entity.groupCodes.find(yCode);
-            auto itZ = entity.groupCodes.find(zCode);
-            
-            if (itX != entity.groupCodes.end() && itY != entity.groupCodes.end() && itZ != entity.groupCodes.end()) {
-                double x = std::stod(itX->second);
-                double y = std::stod(itY->second);
-                double z = std::stod(itZ->second);
-                points.push_back(gp_Pnt(x, y, z));
+            auto x = document.number(entity, 10 + i), y = document.number(entity, 20 + i), z = document.number(entity, 30 + i);
+            if (!x || !y || !z) {
+                continue;
+            }
+            gp_Pnt point(*x, *y, *z);
+            if (points.empty() || !points.back().IsEqual(point, Precision::Confusion())) {
+                points.push_back(point);
             }
         }
-        
-        if (points.size() >= 3) {
-            // Create a face from the points
-            BRepBuilderAPI_MakePolygon polygon;
-            for (const auto& point : points) {
-                polygon.Add(point);
+        if (points.size() > 3 && points.back().IsEqual(points.front(), Precision::Confusion())) {
+            points.pop_back();
+        }
+        if (points.size() < 3) {
+            return TopoDS_Shape();
+        }
+
+        BRepBuilderAPI_MakePolygon polygon;
+        for (const auto& point : points) {
+            polygon.Add(point);
+        }
+        polygon.Close();
+        if (!polygon.IsDone()) {
+            return TopoDS_Shape();
+        }
+        BRepBuilderAPI_MakeFace face(polygon.Wire());
+        return face.IsDone() ? TopoDS_Shape(face.Face()) : TopoDS_Shape();
+    }
+
+    /// @brief Blocks that insert each other deeper than this, or themselves, are not followed further.
+    static constexpr int MAX_DXF_INSERT_DEPTH = 16;
+
+    /// @brief Places the shapes of the block an INSERT names. The base point of the block moves to the
+    /// insertion point, scaled by 41 42 43 and rotated by 50 around Z. Column and row arrays and the
+    /// extrusion direction are not read. Unscaled inserts share the block shapes through their location.
+    static TopoDS_Shape createInsertFromDxf(const DxfDocument& document, const DxfEntity& insert,
+        const std::vector<TopoDS_Shape>& shapes, const std::unordered_map<std::string_view, size_t>& blocks, int depth)
+    {
+        auto name = document.text(insert, 2);
+        auto block = name.has_value() ? blocks.find(*name) : blocks.end();
+        if (block == blocks.end() || depth > MAX_DXF_INSERT_DEPTH) {
+            return TopoDS_Shape();
+        }
+
+        const DxfBlock& dxfBlock = document.blocks[block->second];
+        BRep_Builder builder;
+        TopoDS_Compound compound;
+        builder.MakeCompound(compound);
+        bool isEmpty = true;
+        for (auto index : dxfBlock.entities) {
+            const auto& entity = document.entities[index];
+            auto shape = entity.type == "INSERT" ? createInsertFromDxf(document, entity, shapes, blocks, depth + 1) : shapes[index];
+            if (!shape.IsNull()) {
+                builder.Add(compound, shape);
+                isEmpty = false;
             }
-            
-            if (points.size() == 3) {
-                // Triangle
-                BRepBuilderAPI_MakeFace face(polygon.Wire());
-                return face.Face();
-            } else if (points.size() == 4) {
-                // Quadrilateral
-                polygon.Close();
-                BRepBuilderAPI_MakeFace face(polygon.Wire());
-                return face.Face();
+        }
+        if (isEmpty) {
+            return TopoDS_Shape();
+        }
+
+        const auto& header = document.entities[dxfBlock.header];
+        gp_Trsf toBase, rotation, toPoint;
+        toBase.SetTranslation(-gp_Vec(document.number(header, 10).value_or(0), document.number(header, 20).value_or(0),
+            document.number(header, 30).value_or(0)));
+        rotation.SetRotation(gp::OZ(), document.number(insert, 50).value_or(0) * M_PI / 180.0);
+        toPoint.SetTranslation(gp_Vec(document.number(insert, 10).value_or(0), document.number(insert, 20).value_or(0),
+            document.number(insert, 30).value_or(0)));
+
+        double sx = document.number(insert, 41).value_or(1);
+        double sy = document.number(insert, 42).value_or(sx);
+        double sz = document.number(insert, 43).value_or(sx);
+        if (sx > 0 && std::abs(sx - sy) <= Precision::Confusion() && std::abs(sx - sz) <= Precision::Confusion()) {
+            gp_Trsf scale;
+            scale.SetScale(gp::Origin(), sx);
+            gp_Trsf trsf = toPoint * rotation * scale * toBase;
+            if (std::abs(sx - 1) <= Precision::Confusion()) {
+                return compound.Moved(TopLoc_Location(trsf));
             }
+            BRepBuilderAPI_Transform transform(compound, trsf, true);
+            return transform.IsDone() ? transform.Shape() : TopoDS_Shape();
         }
-        
-        return TopoDS_Shape();
+
+        // mirrored and unevenly scaled blocks need a general transformation of their geometry
+        gp_GTrsf scale;
+        scale.SetValue(1, 1, sx);
+        scale.SetValue(2, 2, sy);
+        scale.SetValue(3, 3, sz);
+        BRepBuilderAPI_GTransform transform(compound, gp_GTrsf(toPoint * rotation) * scale * gp_GTrsf(toBase), true);
+        return transform.IsDone() ? transform.Shape() : TopoDS_Shape();
     }
 
-    static std::optional<ShapeNode> convertFromDxf(const Uint8Array& buffer)
+    enum class DxfEntityType { Unsupported, Line, Circle, Arc, Polyline, Face3D };
+
+    static DxfEntityType dxfEntityType(std::string_view type)
     {
-        std::string dummyFileName = "temp.dxf";
-        writeBufferToFile(dummyFileName, buffer);
+        if (type == "LINE") {
+            return DxfEntityType::Line;
+        } else if (type == "CIRCLE") {
+            return DxfEntityType::Circle;
+        } else if (type == "ARC") {
+            return DxfEntityType::Arc;
+        } else if (type == "POLYLINE" || type == "LWPOLYLINE") {
+            return DxfEntityType::Polyline;
+        } else if (type == "3DFACE") {
+            return DxfEntityType::Face3D;
+        }
+        return DxfEntityType::Unsupported;
+    }
 
-        // Read the DXF file as a text file and parse entities
-        std::ifstream file(dummyFileName, std::ios::binary);
-        if (!file.is_open()) {
-            std::remove(dummyFileName.c_str());
-            return std::nullopt;
+    static TopoDS_Shape createShapeFromDxf(const DxfDocument& document, const DxfEntity& entity)
+    {
+        switch (dxfEntityType(entity.type)) {
+        case DxfEntityType::Line:
+            return createLineFromDxf(document, entity);
+        case DxfEntityType::Circle:
+            return createCircleFromDxf(document, entity);
+        case DxfEntityType::Arc:
+            return createArcFromDxf(document, entity);
+        case DxfEntityType::Polyline:
+            return createPolylineFromDxf(document, entity);
+        case DxfEntityType::Face3D:
+            return create3DFaceFromDxf(document, entity);
+        default:
+            return TopoDS_Shape();
         }
+    }
 
-        // Read file content
-        std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
-        file.close();
-        std::remove(dummyFileName.c_str());
+    /// @brief Builds the entities in parallel and returns one child node per layer, in the order the
+    /// layers first appear, so every layer can be meshed and hidden on its own. The root node has no
+    /// shape, also for a single layer. The entities of blocks only appear where an INSERT places them,
+    /// on the layer of the INSERT.
+    static std::optional<ShapeNode> convertFromDxf(const Uint8Array& buffer)
+    {
+        TRACE_SCOPE("convertFromDxf");
+        std::vector<uint8_t> input = copyInput(buffer);
+        DxfDocument document;
+        {
+            TRACE_SCOPE("DxfDocument::parse");
+            document = DxfDocument::parse(std::string_view((const char*)input.data(), input.size()));
+        }
+        TRACE_COUNT("dxfEntities", document.entities.size());
+
+        std::vector<TopoDS_Shape> shapes(document.entities.size());
+        {
+            TRACE_SCOPE("createShapeFromDxf");
+            OSD_Parallel::For(0, static_cast<int>(shapes.size()), [&document, &shapes](int i) {
+                shapes[i] = createShapeFromDxf(document, document.entities[i]);
+            });
+        }
 
-        // Parse DXF entities
-        std::vector<DxfEntity> entities = parseDxfEntities(content);
+        std::unordered_map<std::string_view, size_t> blocks;
+        for (size_t i = 0; i < document.blocks.size(); i++) {
+            blocks.try_emplace(document.blocks[i].name, i);
+        }
+        std::vector<int> inserts;
+        size_t entityCount = 0;
+        for (size_t i = 0; i < document.entities.size(); i++) {
+            if (document.entities[i].block >= 0) {
+                continue;
+            }
+            entityCount++;
+            if (document.entities[i].type == "INSERT") {
+                inserts.push_back(static_cast<int>(i));
+            }
+        }
+        {
+            // inserts only read the shapes of block entities and only write their own slot
+            TRACE_SCOPE("createInsertFromDxf");
+            OSD_Parallel::For(0, static_cast<int>(inserts.size()), [&](int i) {
+                shapes[inserts[i]] = createInsertFromDxf(document, document.entities[inserts[i]], shapes, blocks, 0);
+            });
+        }
 
-        // Create a compound shape to hold all DXF entities
         BRep_Builder builder;
-        TopoDS_Compound compound;
-        builder.MakeCompound(compound);
-
-        // Process each entity and convert to OpenCascade shapes
-        for (const auto& entity : entities) {
-            TopoDS_Shape shape;
-            
-            if (entity.type == "LINE") {
-                shape = createLineFromDxf(entity);
-            } else if (entity.type == "CIRCLE") {
-                shape = createCircleFromDxf(entity);
-            } else if (entity.type == "ARC") {
-                shape = createArcFromDxf(entity);
-            } else if (entity.type == "POLYLINE" || entity.type == "LWPOLYLINE") {
-                shape = createPolylineFromDxf(entity);
-            } else if (entity.type == "3DFACE") {
-                shape = create3DFaceFromDxf(entity);
+        std::vector<std::pair<std::string_view, TopoDS_Compound>> layers;
+        std::unordered_map<std::string_view, size_t> layerIndex;
+        for (size_t i = 0; i < shapes.size(); i++) {
+            if (shapes[i].IsNull() || document.entities[i].block >= 0) {
+                continue;
             }
-            
-            if (!shape.IsNull()) {
-                builder.Add(compound, shape);
+            auto layer = document.entities[i].layer;
+            auto it = layerIndex.find(layer);
+            if (it == layerIndex.end()) {
+                it = layerIndex.emplace(layer, layers.size()).first;
+                layers.emplace_back(layer, TopoDS_Compound());
+                builder.MakeCompound(layers.back().second);
             }
+            builder.Add(layers[it->second].second, shapes[i]);
         }
 
-        // Create a shape node for the compound
         ShapeNode node = {
-            .shape = compound,
+            .shape = std::nullopt,
             .color = std::nullopt,
             .children = {},
-            .name = "DXF Import (" + std::to_string(entities.size()) + " entities)"
+            .name = "DXF Import (" + std::to_string(entityCount) + " entities)"
         };
+        node.children.reserve(layers.size());
+        for (auto& [layer, compound] : layers) {
+            node.children.push_back(ShapeNode {
+                .shape = compound, .color = std::nullopt, .children = {}, .name = std::string(layer) });
+        }
 
         return node;
     }
 
+    /// @brief Lines, and circles around the Z axis, are written exactly. Every other curve is written as a
+    /// 3D POLYLINE sampled through EdgeDiscretizer.
+    static void writeDxfEdge(std::ostringstream& stream, const TopoDS_Edge& edge, double deflection)
+    {
+        BRepAdaptor_Curve curve(edge);
+        double first = curve.FirstParameter(), last = curve.LastParameter();
+        if (curve.GetType() == GeomAbs_Line) {
+            gp_Pnt p1 = curve.Value(first), p2 = curve.Value(last);
+            stream << "  0\nLINE\n  8\n0\n";
+            stream << " 10\n" << p1.X() << "\n 20\n" << p1.Y() << "\n 30\n" << p1.Z() << "\n";
+            stream << " 11\n" << p2.X() << "\n 21\n" << p2.Y() << "\n 31\n" << p2.Z() << "\n";
+            return;
+        }
+
+        if (curve.GetType() == GeomAbs_Circle && curve.Circle().Axis().Direction().IsParallel(gp::DZ(), Precision::Angular())) {
+            gp_Circ circle = curve.Circle();
+            gp_Pnt center = circle.Location();
+            stream << (last - first >= 2 * M_PI - Precision::PConfusion() ? "  0\nCIRCLE\n  8\n0\n" : "  0\nARC\n  8\n0\n");
+            stream << " 10\n" << center.X() << "\n 20\n" << center.Y() << "\n 30\n" << center.Z() << "\n";
+            stream << " 40\n" << circle.Radius() << "\n";
+            if (last - first < 2 * M_PI - Precision::PConfusion()) {
+                // DXF arcs run counterclockwise around +Z from the world X axis
+                auto angle = [&center](const gp_Pnt& p) { return std::atan2(p.Y() - center.Y(), p.X() - center.X()) * 180.0 / M_PI; };
+                bool isClockwise = circle.Axis().Direction().Z() < 0;
+                double start = angle(curve.Value(isClockwise ? last : first));
+                double end = angle(curve.Value(isClockwise ? first : last));
+                stream << " 50\n" << start << "\n 51\n" << end << "\n";
+            }
+            return;
+        }
+
+        std::vector<gp_Pnt> points;
+        EdgeDiscretizer::discretize(edge, deflection, points);
+        if (points.size() < 2) {
+            return;
+        }
+        stream << "  0\nPOLYLINE\n  8\n0\n 66\n1\n 10\n0\n 20\n0\n 30\n0\n 70\n8\n";
+        for (const auto& point : points) {
+            stream << "  0\nVERTEX\n  8\n0\n";
+            stream << " 10\n" << point.X() << "\n 20\n" << point.Y() << "\n 30\n" << point.Z() << "\n 70\n32\n";
+        }
+        stream << "  0\nSEQEND\n  8\n0\n";
+    }
+
     static std::string convertToDxf(const ShapeArray& input)
     {
         auto shapes = vecFromJSArray<TopoDS_Shape>(input);
@@ -739,50 +968,14 @@ public:
         
         // Process each shape and convert to DXF entities
         for (const auto& shape : shapes) {
+            // the deflection the mesher uses, so edges already shown are not sampled again
+            double deflection = boundingBoxRatio(shape, DXF_LINE_DEFLECTION);
             TopExp_Explorer explorer(shape, TopAbs_EDGE);
             
             while (explorer.More()) {
                 const TopoDS_Edge& edge = TopoDS::Edge(explorer.Current());
-                Standard_Real first, last;
-                Handle(Geom_Curve) curve = BRep_Tool::Curve(edge, first, last);
-                
-                if (!curve.IsNull()) {
-                    // Check curve type
-                    if (curve->DynamicType() == STANDARD_TYPE(Geom_Line)) {
-                        Handle(Geom_Line) line = Handle(Geom_Line)::DownCast(curve);
-                        gp_Pnt p1 = line->Value(first);
-                        gp_Pnt p2 = line->Value(last);
-                        
-                        dxfStream << "  0\nLINE\n  8\n0\n";
-                        dxfStream << " 10\n" << p1.X() << "\n 20\n" << p1.Y() << "\n 30\n" << p1.Z() << "\n";
-                        dxfStream << " 11\n" << p2.X() << "\n 21\n" << p2.Y() << "\n 31\n" << p2.Z() << "\n";
-                    }
-                    else if (curve->DynamicType() == STANDARD_TYPE(Geom_Circle)) {
-                        Handle(Geom_Circle) circle = Handle(Geom_Circle)::DownCast(curve);
-                        gp_Pnt center = circle->Location();
-                        double radius = circle->Radius();
-                        
-                        dxfStream << "  0\nCIRCLE\n  8\n0\n";
-                        dxfStream << " 10\n" << center.X() << "\n 20\n" << center.Y() << "\n 30\n" << center.Z() << "\n";
-                        dxfStream << " 40\n" << radius << "\n";
-                    }
-                    else if (curve->DynamicType() == STANDARD_TYPE(Geom_TrimmedCurve)) {
-                        Handle(Geom_TrimmedCurve) trimmed = Handle(Geom_TrimmedCurve)::DownCast(curve);
-                        Handle(Geom_Circle) circle = Handle(Geom_Circle)::DownCast(trimmed->BasisCurve());
-                        
-                        if (!circle.IsNull()) {
-                            gp_Pnt center = circle->Location();
-                            double radius = circle->Radius();
-                            double startAngle = trimmed->FirstParameter();
-                            double endAngle = trimmed->LastParameter();
-                            
-                            dxfStream << "  0\nARC\n  8\n0\n";
-                            dxfStream << " 10\n" << center.X() << "\n 20\n" << center.Y() << "\n 30\n" << center.Z() << "\n";
-                            dxfStream << " 40\n" << radius << "\n";
-                            dxfStream << " 50\n" << (startAngle * 180.0 / M_PI) << "\n";
-                            dxfStream << " 51\n" << (endAngle * 180.0 / M_PI) << "\n";
-                        }
-                    }
+                if (!BRep_Tool::Degenerated(edge)) {
+                    writeDxfEdge(dxfStream, edge, deflection);
                 }
                 
                 explorer.Next();
@@ -848,6 +1041,206 @@ public:
     }
 };
 
+/// @brief Imports a STEP file one root at a time, so the first parts can be shown while the rest are
+/// still being transferred.
+class StepReader {
+    std::unique_ptr<STEPCAFControl_Reader> reader;
+    Handle(TDocStd_Document) document;
+    Handle(JsProgressIndicator) progress;
+    /// @brief Splits the progress into the read and the transfer, scope counts the transferred roots.
+    std::unique_ptr<Message_ProgressScope> root;
+    std::unique_ptr<Message_ProgressScope> scope;
+    bool isRead = false;
+    int roots = 0;
+    int transferred = 0;
+    /// @brief The tag of the last shape label handed out by transferNext.
+    int lastTag = 0;
+    /// @brief The number of entities the transient process had mapped before the current transfer.
+    int lastMapped = 0;
+    /// @brief The colours of the styled representation items, decoded once when the file is read.
+    std::unordered_map<const Standard_Transient*, std::pair<Quantity_Color, XCAFDoc_ColorType>> itemColors;
+    /// @brief Prototype ids stay stable across transferNext calls.
+    std::unordered_map<TopoDS_Shape, int> prototypes;
+
+public:
+    /// @brief Parses the buffer, onProgress follows JsProgressIndicator and can cancel the transfer.
+    StepReader(const Uint8Array& buffer, const val& onProgress)
+        : reader(std::make_unique<STEPCAFControl_Reader>())
+        , document(new TDocStd_Document("bincaf"))
+        , progress(new JsProgressIndicator(onProgress))
+        , root(std::make_unique<Message_ProgressScope>(progress->Start(), "STEP", 1))
+    {
+        // every XCAF transfer would read the names and colours of the whole model again, transferNext
+        // reads them for the entities of its own root instead
+        reader->SetColorMode(false);
+        reader->SetNameMode(false);
+        isRead = readStep(*reader, buffer, root->Next(STEP_READ_SHARE));
+
+        if (isRead) {
+            loadStyles();
+            roots = reader->NbRootsForTransfer();
+            scope = std::make_unique<Message_ProgressScope>(root->Next(1 - STEP_READ_SHARE), "Transfer", std::max(roots, 1));
+        }
+    }
+
+    bool isOk() const
+    {
+        return isRead;
+    }
+
+    bool isCancelled() const
+    {
+        return progress->isCancelled();
+    }
+
+    bool isDone() const
+    {
+        return !isRead || isCancelled() || transferred >= roots;
+    }
+
+    int rootCount() const
+    {
+        return roots;
+    }
+
+    int transferredCount() const
+    {
+        return transferred;
+    }
+
+    /// @brief Transfers the next root and returns the top-level nodes it added, empty once done.
+    ShapeNodeArray transferNext()
+    {
+        std::vector<ShapeNode> nodes;
+        if (isDone()) {
+            return ShapeNodeArray(val::array(nodes));
+        }
+
+        transferred++;
+        {
+            TRACE_SCOPE("STEPCAFControl_Reader::TransferOneRoot");
+            if (!reader->TransferOneRoot(transferred, document, scope->Next()) || isCancelled()) {
+                return ShapeNodeArray(val::array(nodes));
+            }
+        }
+
+        TDF_Label mainLabel = document->Main();
+        Handle(XCAFDoc_ShapeTool) shapeTool = XCAFDoc_DocumentTool::ShapeTool(mainLabel);
+        Handle(XCAFDoc_ColorTool) colorTool = XCAFDoc_DocumentTool::ColorTool(mainLabel);
+        // the shape tool numbers its labels in creation order, so the labels of this root follow lastTag
+        std::vector<TDF_Label> labels;
+        TDF_Label next = shapeTool->Label().FindChild(lastTag + 1, false);
+        while (!next.IsNull()) {
+            labels.push_back(next);
+            lastTag = next.Tag();
+            next = shapeTool->Label().FindChild(lastTag + 1, false);
+        }
+
+        applyNamesAndColors(labels, shapeTool, colorTool);
+        for (const auto& label : labels) {
+            if (isFreeShape(label, shapeTool)) {
+                nodes.push_back(parseLabelToNode(label, shapeTool, colorTool));
+                assignPrototypes(nodes.back(), prototypes);
+            }
+        }
+
+        return ShapeNodeArray(val::array(nodes));
+    }
+
+private:
+    void loadStyles()
+    {
+        STEPConstruct_Styles styles(reader->ChangeReader().WS());
+        if (!styles.LoadStyles()) {
+            return;
+        }
+        for (int i = 1; i <= styles.NbStyles(); i++) {
+            Handle(StepVisual_StyledItem) style = styles.Style(i);
+            Handle(StepVisual_Colour) surface, boundary, curve, render;
+            Standard_Real transparency = 0;
+            Standard_Boolean isComponent = Standard_False;
+            if (style.IsNull() || !styles.GetColors(style, surface, boundary, curve, render, transparency, isComponent)) {
+                continue;
+            }
+
+            Quantity_Color color;
+            const Standard_Transient* item = style->ItemAP242().Value().get();
+            if (!surface.IsNull() && STEPConstruct_Styles::DecodeColor(surface, color)) {
+                itemColors[item] = { color, XCAFDoc_ColorSurf };
+            } else if (!curve.IsNull() && STEPConstruct_Styles::DecodeColor(curve, color)) {
+                itemColors[item] = { color, XCAFDoc_ColorCurv };
+            } else if (!boundary.IsNull() && STEPConstruct_Styles::DecodeColor(boundary, color)) {
+                itemColors[item] = { color, XCAFDoc_ColorCurv };
+            }
+        }
+    }
+
+    /// @brief The transient process maps entities in transfer order, so the ones after lastMapped are those
+    /// of the current root. Their product names and style colours go on the labels of this root, sub shapes
+    /// without a label get one under the part that contains them.
+    void applyNamesAndColors(const std::vector<TDF_Label>& labels, const Handle(XCAFDoc_ShapeTool) & shapeTool,
+        const Handle(XCAFDoc_ColorTool) & colorTool)
+    {
+        Handle(Transfer_TransientProcess) process = reader->ChangeReader().WS()->TransferReader()->TransientProcess();
+        int mapped = process->NbMapped();
+        std::unordered_map<TopoDS_Shape, TDF_Label> parts;
+        for (int i = lastMapped + 1; i <= mapped; i++) {
+            const Handle(Standard_Transient)& entity = process->Mapped(i);
+            auto color = itemColors.find(entity.get());
+            auto definition = Handle(StepBasic_ProductDefinition)::DownCast(entity);
+            if (color == itemColors.end() && definition.IsNull()) {
+                continue;
+            }
+            TopoDS_Shape shape = TransferBRep::ShapeResult(process->MapItem(i));
+            if (shape.IsNull()) {
+                continue;
+            }
+
+            TDF_Label label;
+            bool isLabeled = shapeTool->Search(shape, label, false, false, false);
+            if (!definition.IsNull() && isLabeled && !definition->Formation().IsNull()) {
+                Handle(StepBasic_Product) product = definition->Formation()->OfProduct();
+                if (!product.IsNull() && !product->Name().IsNull()) {
+                    TDataStd_Name::Set(label, TCollection_ExtendedString(product->Name()->ToCString(), true));
+                }
+            }
+            if (color == itemColors.end()) {
+                continue;
+            }
+            if (!isLabeled) {
+                if (parts.empty()) {
+                    mapPartSubShapes(labels, shapeTool, parts);
+                }
+                auto part = parts.find(shape);
+                if (part == parts.end()) {
+                    continue;
+                }
+                label = shapeTool->AddSubShape(part->second, shape);
+            }
+            if (!label.IsNull()) {
+                colorTool->SetColor(label, color->second.first, color->second.second);
+            }
+        }
+        lastMapped = mapped;
+    }
+
+    /// @brief The sub shapes of the simple shapes among labels, by the label of their part.
+    static void mapPartSubShapes(const std::vector<TDF_Label>& labels, const Handle(XCAFDoc_ShapeTool) & shapeTool,
+        std::unordered_map<TopoDS_Shape, TDF_Label>& parts)
+    {
+        for (const auto& label : labels) {
+            if (!XCAFDoc_ShapeTool::IsSimpleShape(label)) {
+                continue;
+            }
+            TopTools_IndexedMapOfShape subShapes;
+            TopExp::MapShapes(shapeTool->GetShape(label), subShapes);
+            for (TopTools_IndexedMapOfShape::Iterator it(subShapes); it.More(); it.Next()) {
+                parts.try_emplace(it.Value(), label);
+            }
+        }
+    }
+};
+
 EMSCRIPTEN_BINDINGS(Converter)
 {
     register_optional<ShapeNode>();
@@ -858,16 +1251,32 @@ EMSCRIPTEN_BINDINGS(Converter)
         .property("shape", &ShapeNode::shape, return_value_policy::reference())
         .property("color", &ShapeNode::color)
         .property("name", &ShapeNode::name)
+        .property("prototypeId", &ShapeNode::prototypeId)
+        .property("prototype", &ShapeNode::prototype, return_value_policy::reference())
+        .property("location", &ShapeNode::location)
         .function("getChildren", &ShapeNode::getChildren);
 
     class_<Converter>("Converter")
         .class_function("convertToBrep", &Converter::convertToBrep)
         .class_function("convertFromBrep", &Converter::convertFromBrep)
+        .class_function("convertToBinBrep", &Converter::convertToBinBrep)
+        .class_function("convertFromBinBrep", &Converter::convertFromBinBrep)
         .class_function("convertFromStep", &Converter::convertFromStep)
+        .class_function("convertFromStep", &Converter::convertFromStepWithProgress)
         .class_function("convertFromIges", &Converter::convertFromIges)
+        .class_function("convertFromIges", &Converter::convertFromIgesWithProgress)
         .class_function("convertToStep", &Converter::convertToStep)
         .class_function("convertToIges", &Converter::convertToIges)
         .class_function("convertFromStl", &Converter::convertFromStl)
         .class_function("convertFromDxf", &Converter::convertFromDxf)
         .class_function("convertToDxf", &Converter::convertToDxf);
+
+    class_<StepReader>("StepReader")
+        .constructor<const Uint8Array&, const val&>()
+        .function("isOk", &StepReader::isOk)
+        .function("isCancelled", &StepReader::isCancelled)
+        .function("isDone", &StepReader::isDone)
+        .function("rootCount", &StepReader::rootCount)
+        .function("transferredCount", &StepReader::transferredCount)
+        .function("transferNext", &StepReader::transferNext);
 }
\ No newline at end of file
@@ -0,0 +1,241 @@
+// Part of the Chili3d Project, under the AGPL-3.0 License.
+// See LICENSE file in the project root for full license information.
+
+#include "dxf.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+static bool isDxfSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+static std::string_view trimDxfLine(std::string_view line)
+{
+    const char* first = line.data();
+    const char* last = first + line.size();
+    while (first < last && isDxfSpace(*first)) {
+        first++;
+    }
+    while (last > first && isDxfSpace(last[-1])) {
+        last--;
+    }
+    return std::string_view(first, last - first);
+}
+
+static std::string_view nextDxfLine(std::string_view content, size_t& position)
+{
+    size_t end = content.find('\n', position);
+    if (end == std::string_view::npos) {
+        end = content.size();
+    }
+    auto line = content.substr(position, end - position);
+    position = end < content.size() ? end + 1 : end;
+    return trimDxfLine(line);
+}
+
+static std::string_view withoutPlusSign(std::string_view value)
+{
+    return !value.empty() && value.front() == '+' ? value.substr(1) : value;
+}
+
+std::optional<double> parseDxfDouble(std::string_view value)
+{
+    value = withoutPlusSign(value);
+    if (value.empty()) {
+        return std::nullopt;
+    }
+
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+    double result;
+    auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), result);
+    if (error != std::errc() || end != value.data() + value.size()) {
+        return std::nullopt;
+    }
+    return result;
+#else
+    // libc++ has no floating point from_chars yet, strtod needs a terminated copy
+    char buffer[64];
+    if (value.size() >= sizeof(buffer)) {
+        return std::nullopt;
+    }
+    std::memcpy(buffer, value.data(), value.size());
+    buffer[value.size()] = '\0';
+    char* end = nullptr;
+    double result = std::strtod(buffer, &end);
+    if (end != buffer + value.size()) {
+        return std::nullopt;
+    }
+    return result;
+#endif
+}
+
+std::optional<int> parseDxfInt(std::string_view value)
+{
+    value = withoutPlusSign(value);
+    int result;
+    auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), result);
+    if (value.empty() || error != std::errc() || end != value.data() + value.size()) {
+        return std::nullopt;
+    }
+    return result;
+}
+
+DxfDocument DxfDocument::parse(std::string_view content)
+{
+    static const uint32_t NO_VERTEX = std::numeric_limits<uint32_t>::max();
+
+    enum class Section { Other, Entities, Blocks };
+
+    DxfDocument document;
+    // a group takes two lines, counting them is a memchr pass and avoids all of the regrowth
+    document.groups.reserve(std::count(content.begin(), content.end(), '\n') / 2 + 1);
+
+    // files without any SECTION only hold entities
+    Section section = Section::Entities;
+    bool expectSectionName = false;
+    bool inVertex = false;
+    int current = -1;
+    int polyline = -1;
+    int block = -1;
+
+    size_t position = 0;
+    while (position < content.size()) {
+        auto code = parseDxfInt(nextDxfLine(content, position));
+        if (!code.has_value()) {
+            continue;
+        }
+        auto value = nextDxfLine(content, position);
+
+        if (*code == 0) {
+            inVertex = false;
+            if (value == "SECTION" || value == "ENDSEC") {
+                expectSectionName = value == "SECTION";
+                section = Section::Other;
+                current = polyline = block = -1;
+            } else if (section == Section::Other || (section == Section::Blocks && block < 0 && value != "BLOCK")) {
+                current = -1;
+            } else if (value == "ENDBLK") {
+                current = polyline = block = -1;
+            } else if (value == "VERTEX" && polyline >= 0) {
+                auto& entity = document.entities[polyline];
+                if (entity.vertexBegin == NO_VERTEX) {
+                    entity.vertexBegin = entity.end;
+                }
+                inVertex = true;
+                current = polyline;
+            } else if (value == "SEQEND" && polyline >= 0) {
+                current = polyline = -1;
+            } else {
+                current = static_cast<int>(document.entities.size());
+                polyline = value == "POLYLINE" ? current : -1;
+                if (value == "BLOCK" && section == Section::Blocks) {
+                    block = static_cast<int>(document.blocks.size());
+                    document.blocks.push_back(DxfBlock { .name = {}, .header = static_cast<uint32_t>(current), .entities = {} });
+                } else if (block >= 0) {
+                    document.blocks[block].entities.push_back(static_cast<uint32_t>(current));
+                }
+                auto begin = static_cast<uint32_t>(document.groups.size());
+                document.entities.push_back(DxfEntity {
+                    .type = value,
+                    .layer = "0",
+                    .color = 256,
+                    .begin = begin,
+                    .end = begin,
+                    .vertexBegin = polyline >= 0 ? NO_VERTEX : begin,
+                    .block = block,
+                });
+            }
+            continue;
+        }
+
+        if (expectSectionName) {
+            expectSectionName = false;
+            if (*code == 2 && value == "ENTITIES") {
+                section = Section::Entities;
+            } else if (*code == 2 && value == "BLOCKS") {
+                section = Section::Blocks;
+            }
+            continue;
+        }
+        if (current < 0) {
+            continue;
+        }
+
+        auto& entity = document.entities[current];
+        if (!inVertex) {
+            if (*code == 8) {
+                entity.layer = value;
+            } else if (*code == 62) {
+                entity.color = parseDxfInt(value).value_or(256);
+            }
+        }
+        document.groups.push_back(DxfGroup { *code, value });
+        entity.end = static_cast<uint32_t>(document.groups.size());
+    }
+
+    for (auto& entity : document.entities) {
+        if (entity.vertexBegin == NO_VERTEX) {
+            entity.vertexBegin = entity.end;
+        }
+    }
+    for (auto& dxfBlock : document.blocks) {
+        dxfBlock.name = document.text(document.entities[dxfBlock.header], 2).value_or(std::string_view());
+    }
+
+    return document;
+}
+
+/// @brief The VERTEX groups folded into a POLYLINE carry their own 70 and 30, lookups stop before them.
+static uint32_t headerEnd(const DxfEntity& entity)
+{
+    return entity.type == "POLYLINE" ? entity.vertexBegin : entity.end;
+}
+
+std::optional<std::string_view> DxfDocument::text(const DxfEntity& entity, int code) const
+{
+    for (auto i = entity.begin, end = headerEnd(entity); i < end; i++) {
+        if (groups[i].code == code) {
+            return groups[i].value;
+        }
+    }
+    return std::nullopt;
+}
+
+std::optional<double> DxfDocument::number(const DxfEntity& entity, int code) const
+{
+    for (auto i = entity.begin, end = headerEnd(entity); i < end; i++) {
+        if (groups[i].code == code) {
+            return parseDxfDouble(groups[i].value);
+        }
+    }
+    return std::nullopt;
+}
+
+int DxfDocument::integer(const DxfEntity& entity, int code, int defaultValue) const
+{
+    for (auto i = entity.begin, end = headerEnd(entity); i < end; i++) {
+        if (groups[i].code == code) {
+            return parseDxfInt(groups[i].value).value_or(defaultValue);
+        }
+    }
+    return defaultValue;
+}
+
+std::vector<double> DxfDocument::vertices(const DxfEntity& entity) const
+{
+    std::vector<double> result;
+    for (auto i = entity.vertexBegin; i < entity.end; i++) {
+        auto& group = groups[i];
+        if (group.code == 10) {
+            result.insert(result.end(), { parseDxfDouble(group.value).value_or(0), 0, 0 });
+        } else if (!result.empty() && (group.code == 20 || group.code == 30)) {
+            result[result.size() - (group.code == 20 ? 2 : 1)] = parseDxfDouble(group.value).value_or(0);
+        }
+    }
+    return result;
+}
@@ -0,0 +1,67 @@
+// Part of the Chili3d Project, under the AGPL-3.0 License.
+// See LICENSE file in the project root for full license information.
+
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+/// @brief One code/value pair, the value points into the parsed buffer.
+struct DxfGroup {
+    int code;
+    std::string_view value;
+};
+
+/// @brief An entity of the ENTITIES or the BLOCKS section, its groups are [begin, end) of DxfDocument::groups.
+struct DxfEntity {
+    std::string_view type;
+    std::string_view layer;
+    /// @brief The ACI color of group 62, 256 (BYLAYER) when it is missing.
+    int color;
+    uint32_t begin;
+    uint32_t end;
+    /// @brief Where the vertex groups start. For a POLYLINE this is after its header, which carries a
+    /// dummy point, and the groups of its VERTEX entities follow up to the SEQEND.
+    uint32_t vertexBegin;
+    /// @brief The index in DxfDocument::blocks of the block the entity belongs to, -1 in ENTITIES.
+    int block;
+};
+
+/// @brief A block of the BLOCKS section, placed by the INSERT entities that name it.
+struct DxfBlock {
+    std::string_view name;
+    /// @brief The BLOCK entity, its groups hold the base point.
+    uint32_t header;
+    /// @brief The entities between BLOCK and ENDBLK.
+    std::vector<uint32_t> entities;
+};
+
+/// @brief The entities and blocks of a DXF file, tokenized in one pass without copying the buffer. Keep
+/// the buffer alive while the document is used, repeated group codes such as LWPOLYLINE vertices are
+/// kept in order. The other sections, such as HEADER and TABLES, are skipped.
+class DxfDocument {
+public:
+    std::vector<DxfGroup> groups;
+    std::vector<DxfEntity> entities;
+    std::vector<DxfBlock> blocks;
+
+    static DxfDocument parse(std::string_view content);
+
+    /// @brief The value of the first group with the code, std::nullopt if it is missing. Only the groups
+    /// of the entity itself are searched, for a POLYLINE not those of its VERTEX entities.
+    std::optional<std::string_view> text(const DxfEntity& entity, int code) const;
+
+    /// @brief The value of the first group with the code, std::nullopt if it is missing or not a number.
+    std::optional<double> number(const DxfEntity& entity, int code) const;
+
+    int integer(const DxfEntity& entity, int code, int defaultValue) const;
+
+    /// @brief The x, y, z rows of 10/20/30 groups from the vertex groups of the entity.
+    std::vector<double> vertices(const DxfEntity& entity) const;
+};
+
+std::optional<double> parseDxfDouble(std::string_view value);
+
+std::optional<int> parseDxfInt(std::string_view value);
@@ -4,8 +4,11 @@
 #include <emscripten/bind.h>
 #include <emscripten/val.h>
 
+#include "progress.hpp"
 #include "shared.hpp"
+#include "trace.hpp"
 #include "utils.hpp"
+#include <BOPAlgo_GlueEnum.hxx>
 #include <BRepAlgoAPI_BooleanOperation.hxx>
 #include <BRepAlgoAPI_Common.hxx>
 #include <BRepAlgoAPI_Cut.hxx>
@@ -30,7 +33,9 @@
 #include <BRepPrimAPI_MakeRevol.hxx>
 #include <BRepPrimAPI_MakeSphere.hxx>
 #include <BRepProj_Projection.hxx>
+#include <Bnd_Box.hxx>
 #include <Geom_BezierCurve.hxx>
+#include <OSD_Parallel.hxx>
 #include <ShapeAnalysis_Edge.hxx>
 #include <ShapeAnalysis_WireOrder.hxx>
 #include <ShapeUpgrade_UnifySameDomain.hxx>
@@ -39,6 +44,8 @@
 #include <gp_Ax2.hxx>
 #include <gp_Circ.hxx>
 
+#include <algorithm>
+
 using namespace emscripten;
 
 struct ShapeResult {
@@ -47,7 +54,33 @@ struct ShapeResult {
     std::string error;
 };
 
+/// @brief The BOPAlgo options of a boolean operation, the two argument overloads keep the OCCT defaults.
+struct BooleanOptions {
+    bool parallel;
+    /// @brief Additional tolerance for the intersections, 0 to use the tolerances of the shapes only.
+    double fuzzyValue;
+    /// @brief Filters the interfering sub shapes with oriented bounding boxes first.
+    bool useOBB;
+    /// @brief Speeds up arguments that only touch or coincide, BOPAlgo_GlueOff when they intersect.
+    BOPAlgo_GlueEnum glue;
+    /// @brief Keeps the arguments untouched, at the price of copying the modified sub shapes.
+    bool nonDestructive;
+};
+
 class ShapeFactory {
+    /// @brief Runs the operation with a range of the onProgress callback and turns its cancellation into
+    /// a failed result, whatever the builder left behind.
+    template <typename TOperation>
+    static ShapeResult withProgress(const val& onProgress, TOperation&& operation)
+    {
+        Handle(JsProgressIndicator) progress = new JsProgressIndicator(onProgress);
+        ShapeResult result = operation(progress->Start());
+        if (progress->isCancelled()) {
+            return ShapeResult { TopoDS_Shape(), false, CANCELLED_ERROR };
+        }
+        return result;
+    }
+
 public:
     static ShapeResult box(const Pln& ax3, double x, double y, double z)
     {
@@ -193,6 +226,20 @@ public:
     }
 
     static ShapeResult sweep(const ShapeArray& sections, const TopoDS_Wire& path, bool isFrenet, bool isForceC1)
+    {
+        return sweepWithProgress(sections, path, isFrenet, isForceC1, val::undefined());
+    }
+
+    static ShapeResult sweepWithProgress(
+        const ShapeArray& sections, const TopoDS_Wire& path, bool isFrenet, bool isForceC1, const val& onProgress)
+    {
+        return withProgress(onProgress, [&](const Message_ProgressRange& range) {
+            return sweep(sections, path, isFrenet, isForceC1, range);
+        });
+    }
+
+    static ShapeResult sweep(const ShapeArray& sections, const TopoDS_Wire& path, bool isFrenet, bool isForceC1,
+        const Message_ProgressRange& range)
     {
         BRepOffsetAPI_MakePipeShell pipe(path);
         if (isFrenet) {
@@ -211,7 +258,10 @@ public:
             pipe.Add(shape);
         }
 
-        pipe.Build();
+        {
+            TRACE_SCOPE("BRepOffsetAPI_MakePipeShell::Build");
+            pipe.Build(range);
+        }
         pipe.MakeSolid();
 
         if (!pipe.IsDone()) {
@@ -411,24 +461,50 @@ public:
 
     static ShapeResult makeThickSolidBySimple(const TopoDS_Shape& shape, double thickness)
     {
-        BRepOffsetAPI_MakeThickSolid makeThickSolid;
-        makeThickSolid.MakeThickSolidBySimple(shape, thickness);
-        if (!makeThickSolid.IsDone()) {
-            return ShapeResult { TopoDS_Shape(), false, "Failed to create thick solid" };
-        }
-        return ShapeResult { makeThickSolid.Shape(), true, "" };
+        return makeThickSolidBySimpleWithProgress(shape, thickness, val::undefined());
+    }
+
+    /// @brief The simple offset takes no progress range, the callback only sees its start, where returning
+    /// false skips it, and its end.
+    static ShapeResult makeThickSolidBySimpleWithProgress(const TopoDS_Shape& shape, double thickness, const val& onProgress)
+    {
+        return withProgress(onProgress, [&](const Message_ProgressRange& range) {
+            Message_ProgressScope scope(range, "Thick solid", 1);
+            scope.Show();
+            if (!scope.More()) {
+                return ShapeResult { TopoDS_Shape(), false, CANCELLED_ERROR };
+            }
+
+            TRACE_SCOPE("BRepOffsetAPI_MakeThickSolid::MakeThickSolidBySimple");
+            BRepOffsetAPI_MakeThickSolid makeThickSolid;
+            makeThickSolid.MakeThickSolidBySimple(shape, thickness);
+            scope.Next();
+            if (!makeThickSolid.IsDone()) {
+                return ShapeResult { TopoDS_Shape(), false, "Failed to create thick solid" };
+            }
+            return ShapeResult { makeThickSolid.Shape(), true, "" };
+        });
     }
 
     static ShapeResult makeThickSolidByJoin(const TopoDS_Shape& shape, const ShapeArray& shapes, double thickness)
     {
-        TopTools_ListOfShape shapesList = shapeArrayToListOfShape(shapes);
+        return makeThickSolidByJoinWithProgress(shape, shapes, thickness, val::undefined());
+    }
 
-        BRepOffsetAPI_MakeThickSolid makeThickSolid;
-        makeThickSolid.MakeThickSolidByJoin(shape, shapesList, thickness, 1e-6);
-        if (!makeThickSolid.IsDone()) {
-            return ShapeResult { TopoDS_Shape(), false, "Failed to create thick solid" };
-        }
-        return ShapeResult { makeThickSolid.Shape(), true, "" };
+    static ShapeResult makeThickSolidByJoinWithProgress(
+        const TopoDS_Shape& shape, const ShapeArray& shapes, double thickness, const val& onProgress)
+    {
+        TopTools_ListOfShape shapesList = shapeArrayToListOfShape(shapes);
+        return withProgress(onProgress, [&](const Message_ProgressRange& range) {
+            TRACE_SCOPE("BRepOffsetAPI_MakeThickSolid::MakeThickSolidByJoin");
+            BRepOffsetAPI_MakeThickSolid makeThickSolid;
+            makeThickSolid.MakeThickSolidByJoin(shape, shapesList, thickness, 1e-6, BRepOffset_Skin, false, false,
+                GeomAbs_Arc, false, range);
+            if (!makeThickSolid.IsDone()) {
+                return ShapeResult { TopoDS_Shape(), false, "Failed to create thick solid" };
+            }
+            return ShapeResult { makeThickSolid.Shape(), true, "" };
+        });
     }
 
     static ShapeResult simplifyShape(
@@ -449,13 +525,27 @@ public:
     static ShapeResult booleanOperate(BRepAlgoAPI_BooleanOperation& boolOperater, const ShapeArray& args,
         const ShapeArray& tools)
     {
-        TopTools_ListOfShape argsList = shapeArrayToListOfShape(args);
-        TopTools_ListOfShape toolsList = shapeArrayToListOfShape(tools);
+        return booleanOperate(boolOperater, shapeArrayToListOfShape(args), shapeArrayToListOfShape(tools), nullptr,
+            Message_ProgressRange());
+    }
 
+    static ShapeResult booleanOperate(BRepAlgoAPI_BooleanOperation& boolOperater, const TopTools_ListOfShape& argsList,
+        const TopTools_ListOfShape& toolsList, const BooleanOptions* options, const Message_ProgressRange& range)
+    {
         boolOperater.SetToFillHistory(false);
+        if (options) {
+            boolOperater.SetRunParallel(options->parallel);
+            boolOperater.SetFuzzyValue(options->fuzzyValue);
+            boolOperater.SetUseOBB(options->useOBB);
+            boolOperater.SetGlue(options->glue);
+            boolOperater.SetNonDestructive(options->nonDestructive);
+        }
         boolOperater.SetArguments(argsList);
         boolOperater.SetTools(toolsList);
-        boolOperater.Build();
+        {
+            TRACE_SCOPE("BRepAlgoAPI_BooleanOperation::Build");
+            boolOperater.Build(range);
+        }
         if (!boolOperater.IsDone()) {
             return ShapeResult { TopoDS_Shape(), false, "Failed to build boolean operation" };
         }
@@ -481,6 +571,132 @@ public:
         return booleanOperate(api, args, tools);
     }
 
+    static ShapeResult booleanCommonWithOptions(const ShapeArray& args, const ShapeArray& tools, const BooleanOptions& options)
+    {
+        return booleanCommonWithProgress(args, tools, options, val::undefined());
+    }
+
+    static ShapeResult booleanCommonWithProgress(
+        const ShapeArray& args, const ShapeArray& tools, const BooleanOptions& options, const val& onProgress)
+    {
+        return withProgress(onProgress, [&](const Message_ProgressRange& range) {
+            BRepAlgoAPI_Common api;
+            return booleanOperate(api, shapeArrayToListOfShape(args), shapeArrayToListOfShape(tools), &options, range);
+        });
+    }
+
+    static ShapeResult booleanCutWithOptions(const ShapeArray& args, const ShapeArray& tools, const BooleanOptions& options)
+    {
+        return booleanCutWithProgress(args, tools, options, val::undefined());
+    }
+
+    static ShapeResult booleanCutWithProgress(
+        const ShapeArray& args, const ShapeArray& tools, const BooleanOptions& options, const val& onProgress)
+    {
+        return withProgress(onProgress, [&](const Message_ProgressRange& range) {
+            BRepAlgoAPI_Cut api;
+            return booleanOperate(api, shapeArrayToListOfShape(args), shapeArrayToListOfShape(tools), &options, range);
+        });
+    }
+
+    static ShapeResult booleanFuseWithOptions(const ShapeArray& args, const ShapeArray& tools, const BooleanOptions& options)
+    {
+        return booleanFuseWithProgress(args, tools, options, val::undefined());
+    }
+
+    static ShapeResult booleanFuseWithProgress(
+        const ShapeArray& args, const ShapeArray& tools, const BooleanOptions& options, const val& onProgress)
+    {
+        return withProgress(onProgress, [&](const Message_ProgressRange& range) {
+            BRepAlgoAPI_Fuse api;
+            return booleanOperate(api, shapeArrayToListOfShape(args), shapeArrayToListOfShape(tools), &options, range);
+        });
+    }
+
+    /// @brief Cuts many tools, such as a hole pattern, out of one shape. The tools are ordered along a Morton
+    /// curve of their bounding box centers and cut in batches of batchSize neighbours, so every operation
+    /// only meets the faces of one region. The batches are cut one after another, each from the result of
+    /// the previous one; only options.parallel runs the intersections inside a batch concurrently. Cutting
+    /// disjoint batches from separate copies would need another boolean to merge them, which meets every
+    /// face again. A batchSize of 0 cuts all tools in one operation, which with useOBB and parallel is often
+    /// fastest when the tools do not overlap each other.
+    static ShapeResult booleanCutMany(const TopoDS_Shape& shape, const ShapeArray& tools, int batchSize, const BooleanOptions& options)
+    {
+        return booleanCutManyWithProgress(shape, tools, batchSize, options, val::undefined());
+    }
+
+    static ShapeResult booleanCutManyWithProgress(const TopoDS_Shape& shape, const ShapeArray& tools, int batchSize,
+        const BooleanOptions& options, const val& onProgress)
+    {
+        return withProgress(onProgress, [&](const Message_ProgressRange& range) {
+            return booleanCutMany(shape, tools, batchSize, options, range);
+        });
+    }
+
+    static ShapeResult booleanCutMany(const TopoDS_Shape& shape, const ShapeArray& tools, int batchSize,
+        const BooleanOptions& options, const Message_ProgressRange& range)
+    {
+        std::vector<TopoDS_Shape> toolVec = vecFromJSArray<TopoDS_Shape>(tools);
+        int count = static_cast<int>(toolVec.size());
+        if (count == 0) {
+            return ShapeResult { shape, true, "" };
+        }
+
+        std::vector<gp_Pnt> centers(count);
+        OSD_Parallel::For(0, count, [&toolVec, &centers](int i) {
+            Bnd_Box box = ShapeCache::bounds(toolVec[i]);
+            centers[i] = box.IsVoid() ? gp_Pnt() : gp_Pnt((box.CornerMin().XYZ() + box.CornerMax().XYZ()) / 2);
+        });
+        Bnd_Box bounds;
+        for (auto& center : centers) {
+            bounds.Add(center);
+        }
+        std::vector<std::pair<uint32_t, int>> order(count);
+        for (int i = 0; i < count; i++) {
+            order[i] = { mortonCode(bounds, centers[i]), i };
+        }
+        std::sort(order.begin(), order.end());
+
+        size_t step = batchSize > 0 ? batchSize : count;
+        Message_ProgressScope scope(range, "Cut", static_cast<double>((order.size() + step - 1) / step));
+        TopoDS_Shape result = shape;
+        for (size_t begin = 0; begin < order.size() && scope.More(); begin += step) {
+            TopTools_ListOfShape argsList, toolsList;
+            argsList.Append(result);
+            for (size_t i = begin; i < std::min(order.size(), begin + step); i++) {
+                toolsList.Append(toolVec[order[i].second]);
+            }
+
+            BRepAlgoAPI_Cut api;
+            auto cut = booleanOperate(api, argsList, toolsList, &options, scope.Next());
+            if (!cut.isOk) {
+                return cut;
+            }
+            result = cut.shape;
+        }
+        return ShapeResult { result, true, "" };
+    }
+
+    /// @brief 10 bits per axis of the point inside the bounds, interleaved.
+    static uint32_t mortonCode(const Bnd_Box& bounds, const gp_Pnt& point)
+    {
+        auto spread = [](uint32_t v) {
+            v = (v | (v << 16)) & 0x030000FF;
+            v = (v | (v << 8)) & 0x0300F00F;
+            v = (v | (v << 4)) & 0x030C30C3;
+            v = (v | (v << 2)) & 0x09249249;
+            return v;
+        };
+        gp_XYZ size = bounds.CornerMax().XYZ() - bounds.CornerMin().XYZ();
+        gp_XYZ offset = point.XYZ() - bounds.CornerMin().XYZ();
+        uint32_t code = 0;
+        for (int axis = 1; axis <= 3; axis++) {
+            double t = size.Coord(axis) > 0 ? offset.Coord(axis) / size.Coord(axis) : 0;
+            code |= spread(static_cast<uint32_t>(std::clamp(t, 0.0, 1.0) * 1023)) << (3 - axis);
+        }
+        return code;
+    }
+
     static ShapeResult combine(const ShapeArray& shapes)
     {
         std::vector<TopoDS_Shape> shapesVec = vecFromJSArray<TopoDS_Shape>(shapes);
@@ -495,42 +711,63 @@ public:
 
     static ShapeResult fillet(const TopoDS_Shape& shape, const NumberArray& edges, double radius)
     {
-        std::vector<int> edgeVec = vecFromJSArray<int>(edges);
+        return filletWithProgress(shape, edges, radius, val::undefined());
+    }
 
-        TopTools_IndexedMapOfShape edgeMap;
-        TopExp::MapShapes(shape, TopAbs_EDGE, edgeMap);
+    static ShapeResult filletWithProgress(
+        const TopoDS_Shape& shape, const NumberArray& edges, double radius, const val& onProgress)
+    {
+        std::vector<int> edgeVec = vecFromJSArray<int>(edges);
 
-        BRepFilletAPI_MakeFillet makeFillet(shape);
-        for (auto edge : edgeVec) {
-            makeFillet.Add(radius, TopoDS::Edge(edgeMap.FindKey(edge + 1)));
-        }
-        makeFillet.Build();
-        if (!makeFillet.IsDone()) {
-            return ShapeResult { TopoDS_Shape(), false, "Failed to fillet" };
-        }
+        auto edgeMap = ShapeCache::subShapes(shape, TopAbs_EDGE);
 
-        return ShapeResult { makeFillet.Shape(), true, "" };
+        return withProgress(onProgress, [&](const Message_ProgressRange& range) {
+            BRepFilletAPI_MakeFillet makeFillet(shape);
+            for (auto edge : edgeVec) {
+                makeFillet.Add(radius, TopoDS::Edge(edgeMap->FindKey(edge + 1)));
+            }
+            TRACE_SCOPE("BRepFilletAPI_MakeFillet::Build");
+            makeFillet.Build(range);
+            if (!makeFillet.IsDone()) {
+                return ShapeResult { TopoDS_Shape(), false, "Failed to fillet" };
+            }
+            return ShapeResult { makeFillet.Shape(), true, "" };
+        });
     }
 
     static ShapeResult chamfer(const TopoDS_Shape& shape, const NumberArray& edges, double distance)
+    {
+        return chamferWithProgress(shape, edges, distance, val::undefined());
+    }
+
+    static ShapeResult chamferWithProgress(
+        const TopoDS_Shape& shape, const NumberArray& edges, double distance, const val& onProgress)
     {
         std::vector<int> edgeVec = vecFromJSArray<int>(edges);
 
-        TopTools_IndexedMapOfShape edgeMap;
-        TopExp::MapShapes(shape, TopAbs_EDGE, edgeMap);
+        auto edgeMap = ShapeCache::subShapes(shape, TopAbs_EDGE);
 
-        BRepFilletAPI_MakeChamfer makeChamfer(shape);
-        for (auto edge : edgeVec) {
-            makeChamfer.Add(distance, TopoDS::Edge(edgeMap.FindKey(edge + 1)));
-        }
-        makeChamfer.Build();
-        if (!makeChamfer.IsDone()) {
-            return ShapeResult { TopoDS_Shape(), false, "Failed to chamfer" };
-        }
-        return ShapeResult { makeChamfer.Shape(), true, "" };
+        return withProgress(onProgress, [&](const Message_ProgressRange& range) {
+            BRepFilletAPI_MakeChamfer makeChamfer(shape);
+            for (auto edge : edgeVec) {
+                makeChamfer.Add(distance, TopoDS::Edge(edgeMap->FindKey(edge + 1)));
+            }
+            TRACE_SCOPE("BRepFilletAPI_MakeChamfer::Build");
+            makeChamfer.Build(range);
+            if (!makeChamfer.IsDone()) {
+                return ShapeResult { TopoDS_Shape(), false, "Failed to chamfer" };
+            }
+            return ShapeResult { makeChamfer.Shape(), true, "" };
+        });
     }
 
     static ShapeResult loft(const ShapeArray& sections, bool isSolid, bool isRuled, GeomAbs_Shape continuity)
+    {
+        return loftWithProgress(sections, isSolid, isRuled, continuity, val::undefined());
+    }
+
+    static ShapeResult loftWithProgress(
+        const ShapeArray& sections, bool isSolid, bool isRuled, GeomAbs_Shape continuity, const val& onProgress)
     {
         std::vector<TopoDS_Shape> shapeVector = emscripten::vecFromJSArray<TopoDS_Shape>(sections);
         if (shapeVector.size() < 2) {
@@ -540,23 +777,26 @@ public:
             return ShapeResult { TopoDS_Shape(), false, "Failed to loft: must have at least 1 wires" };
         }
 
-        BRepOffsetAPI_ThruSections loftBuilder(isSolid, isRuled);
-        if (!isRuled) {
-            loftBuilder.SetContinuity(continuity);
-        }
+        return withProgress(onProgress, [&](const Message_ProgressRange& range) {
+            BRepOffsetAPI_ThruSections loftBuilder(isSolid, isRuled);
+            if (!isRuled) {
+                loftBuilder.SetContinuity(continuity);
+            }
 
-        for (auto& profile : shapeVector) {
-            if (profile.ShapeType() == TopAbs_WIRE) {
-                loftBuilder.AddWire(TopoDS::Wire(profile));
-            } else if (profile.ShapeType() == TopAbs_VERTEX) {
-                loftBuilder.AddVertex(TopoDS::Vertex(profile));
+            for (auto& profile : shapeVector) {
+                if (profile.ShapeType() == TopAbs_WIRE) {
+                    loftBuilder.AddWire(TopoDS::Wire(profile));
+                } else if (profile.ShapeType() == TopAbs_VERTEX) {
+                    loftBuilder.AddVertex(TopoDS::Vertex(profile));
+                }
             }
-        }
-        loftBuilder.Build();
-        if (!loftBuilder.IsDone()) {
-            return ShapeResult { TopoDS_Shape(), false, "Failed to loft" };
-        }
-        return ShapeResult { loftBuilder.Shape(), true, "" };
+            TRACE_SCOPE("BRepOffsetAPI_ThruSections::Build");
+            loftBuilder.Build(range);
+            if (!loftBuilder.IsDone()) {
+                return ShapeResult { TopoDS_Shape(), false, "Failed to loft" };
+            }
+            return ShapeResult { loftBuilder.Shape(), true, "" };
+        });
     }
 
     static ShapeResult curveProjection(const TopoDS_Shape& curve, const TopoDS_Shape& targetFace, const gp_Dir& dir)
@@ -576,6 +816,18 @@ EMSCRIPTEN_BINDINGS(ShapeFactory)
         .property("isOk", &ShapeResult::isOk)
         .property("error", &ShapeResult::error);
 
+    enum_<BOPAlgo_GlueEnum>("BOPAlgo_GlueEnum")
+        .value("BOPAlgo_GlueOff", BOPAlgo_GlueOff)
+        .value("BOPAlgo_GlueShift", BOPAlgo_GlueShift)
+        .value("BOPAlgo_GlueFull", BOPAlgo_GlueFull);
+
+    value_object<BooleanOptions>("BooleanOptions")
+        .field("parallel", &BooleanOptions::parallel)
+        .field("fuzzyValue", &BooleanOptions::fuzzyValue)
+        .field("useOBB", &BooleanOptions::useOBB)
+        .field("glue", &BooleanOptions::glue)
+        .field("nonDestructive", &BooleanOptions::nonDestructive);
+
     class_<ShapeFactory>("ShapeFactory")
         .class_function("box", &ShapeFactory::box)
         .class_function("cone", &ShapeFactory::cone)
@@ -584,7 +836,8 @@ EMSCRIPTEN_BINDINGS(ShapeFactory)
         .class_function("ellipse", &ShapeFactory::ellipse)
         .class_function("cylinder", &ShapeFactory::cylinder)
         .class_function("pyramid", &ShapeFactory::pyramid)
-        .class_function("sweep", &ShapeFactory::sweep)
+        .class_function("sweep", select_overload<ShapeResult(const ShapeArray&, const TopoDS_Wire&, bool, bool)>(&ShapeFactory::sweep))
+        .class_function("sweep", &ShapeFactory::sweepWithProgress)
         .class_function("revolve", &ShapeFactory::revolve)
         .class_function("prism", &ShapeFactory::prism)
         .class_function("polygon", &ShapeFactory::polygon)
@@ -599,14 +852,29 @@ EMSCRIPTEN_BINDINGS(ShapeFactory)
         .class_function("shell", &ShapeFactory::shell)
         .class_function("solid", &ShapeFactory::solid)
         .class_function("makeThickSolidBySimple", &ShapeFactory::makeThickSolidBySimple)
+        .class_function("makeThickSolidBySimple", &ShapeFactory::makeThickSolidBySimpleWithProgress)
         .class_function("makeThickSolidByJoin", &ShapeFactory::makeThickSolidByJoin)
+        .class_function("makeThickSolidByJoin", &ShapeFactory::makeThickSolidByJoinWithProgress)
         .class_function("simplifyShape", &ShapeFactory::simplifyShape)
         .class_function("booleanCommon", &ShapeFactory::booleanCommon)
         .class_function("booleanCut", &ShapeFactory::booleanCut)
         .class_function("booleanFuse", &ShapeFactory::booleanFuse)
+        .class_function("booleanCommon", &ShapeFactory::booleanCommonWithOptions)
+        .class_function("booleanCut", &ShapeFactory::booleanCutWithOptions)
+        .class_function("booleanFuse", &ShapeFactory::booleanFuseWithOptions)
+        .class_function("booleanCommon", &ShapeFactory::booleanCommonWithProgress)
+        .class_function("booleanCut", &ShapeFactory::booleanCutWithProgress)
+        .class_function("booleanFuse", &ShapeFactory::booleanFuseWithProgress)
+        .class_function("booleanCutMany",
+            select_overload<ShapeResult(const TopoDS_Shape&, const ShapeArray&, int, const BooleanOptions&)>(
+                &ShapeFactory::booleanCutMany))
+        .class_function("booleanCutMany", &ShapeFactory::booleanCutManyWithProgress)
         .class_function("combine", &ShapeFactory::combine)
         .class_function("fillet", &ShapeFactory::fillet)
+        .class_function("fillet", &ShapeFactory::filletWithProgress)
         .class_function("chamfer", &ShapeFactory::chamfer)
+        .class_function("chamfer", &ShapeFactory::chamferWithProgress)
         .class_function("loft", &ShapeFactory::loft)
+        .class_function("loft", &ShapeFactory::loftWithProgress)
         .class_function("curveProjection", &ShapeFactory::curveProjection);
 }
\ No newline at end of file
@@ -16,6 +16,7 @@
 #include <Standard_Handle.hxx>
 #include <gp_Dir.hxx>
 #include <gp_Pnt.hxx>
+#include <limits>
 #include <optional>
 
 #include "shared.hpp"
@@ -23,6 +24,19 @@
 
 using namespace emscripten;
 
+/// @brief The packed points of a batch query, x y z of each point after another.
+static std::vector<gp_Pnt> unpackPoints(const Float64Array& points)
+{
+    std::vector<double> coords = convertJSArrayToNumberVector<double>(points);
+    std::vector<gp_Pnt> result(coords.size() / 3);
+    for (size_t i = 0; i < result.size(); i++) {
+        result[i].SetCoord(coords[i * 3], coords[i * 3 + 1], coords[i * 3 + 2]);
+    }
+    return result;
+}
+
+constexpr double NO_VALUE = std::numeric_limits<double>::quiet_NaN();
+
 class Curve {
 private:
     static Vector3Array getPoints(const GCPnts_UniformAbscissa& uniformAbscissa, const Geom_Curve* curve)
@@ -34,6 +48,25 @@ private:
         return Vector3Array(val::array(points));
     }
 
+    template <typename TAbscissa>
+    static PointSamples sampleCurves(const CurveArray& curves, const TAbscissa& abscissa)
+    {
+        auto curveVec = vecFromJSArray<const Geom_Curve*>(curves, allow_raw_pointers());
+        std::vector<std::vector<gp_Pnt>> samples(curveVec.size());
+        for (size_t i = 0; i < curveVec.size(); i++) {
+            GeomAdaptor_Curve adaptorCurve(curveVec[i]);
+            GCPnts_UniformAbscissa uniformAbscissa(adaptorCurve, abscissa);
+            if (!uniformAbscissa.IsDone()) {
+                continue;
+            }
+            samples[i].resize(uniformAbscissa.NbPoints());
+            for (int j = 0; j < uniformAbscissa.NbPoints(); j++) {
+                samples[i][j] = curveVec[i]->Value(uniformAbscissa.Parameter(j + 1));
+            }
+        }
+        return packSamples<Float64Array, double>(samples);
+    }
+
 public:
     static Handle_Geom_Line makeLine(const Vector3& start, const Vector3& dir)
     {
@@ -91,6 +124,18 @@ public:
         return getPoints(uniformAbscissa, curve);
     }
 
+    /// @brief uniformAbscissaWithLength of many curves at once, curves that cannot be sampled get no points.
+    static PointSamples uniformAbscissaBatchWithLength(const CurveArray& curves, double length)
+    {
+        return sampleCurves(curves, length);
+    }
+
+    /// @brief uniformAbscissaWithCount of many curves at once, curves that cannot be sampled get no points.
+    static PointSamples uniformAbscissaBatchWithCount(const CurveArray& curves, int nbPoints)
+    {
+        return sampleCurves(curves, nbPoints);
+    }
+
     static ProjectPointResult projectOrNearest(const Geom_Curve* curve, const Vector3& point)
     {
         gp_Pnt pnt = Vector3::toPnt(point);
@@ -112,6 +157,53 @@ public:
         GeomAdaptor_Curve adaptorCurve(curve);
         return GCPnts_AbscissaPoint::Length(adaptorCurve);
     }
+
+    /// @brief projectOrNearest for packed points, one extrema setup serves all of them. Returns x y z
+    /// distance parameter for every point.
+    static Float64Array projectOrNearestBatch(const Geom_Curve* curve, const Float64Array& points)
+    {
+        auto pnts = unpackPoints(points);
+        std::vector<double> result(pnts.size() * 5);
+        GeomAPI_ProjectPointOnCurve projector;
+        projector.Init(curve, curve->FirstParameter(), curve->LastParameter());
+        for (size_t i = 0; i < pnts.size(); i++) {
+            projector.Perform(pnts[i]);
+            ProjectPointResult nearest = projector.NbPoints() > 0
+                ? ProjectPointResult { .point = Vector3::fromPnt(projector.NearestPoint()),
+                      .distance = projector.LowerDistance(),
+                      .parameter = projector.LowerDistanceParameter() }
+                : nearestEnd(curve, pnts[i]);
+            double* out = result.data() + i * 5;
+            out[0] = nearest.point.x;
+            out[1] = nearest.point.y;
+            out[2] = nearest.point.z;
+            out[3] = nearest.distance;
+            out[4] = nearest.parameter;
+        }
+        return typedArrayCopy<Float64Array>(result);
+    }
+
+    /// @brief parameter for packed points, NaN for points farther than maxDistance from the curve.
+    static Float64Array parameterBatch(const Geom_Curve* curve, const Float64Array& points, double maxDistance)
+    {
+        auto pnts = unpackPoints(points);
+        std::vector<double> result(pnts.size(), NO_VALUE);
+        GeomAPI_ProjectPointOnCurve projector;
+        projector.Init(curve, curve->FirstParameter(), curve->LastParameter());
+        for (size_t i = 0; i < pnts.size(); i++) {
+            projector.Perform(pnts[i]);
+            if (projector.NbPoints() > 0 && projector.LowerDistance() <= maxDistance) {
+                result[i] = projector.LowerDistanceParameter();
+                continue;
+            }
+            // like GeomLib_Tool, ends of bounded curves count when the projection finds no solution
+            auto end = nearestEnd(curve, pnts[i]);
+            if (end.distance <= maxDistance) {
+                result[i] = end.parameter;
+            }
+        }
+        return typedArrayCopy<Float64Array>(result);
+    }
 };
 
 struct SurfaceBounds {
@@ -173,6 +265,55 @@ public:
         surface->Bounds(u1, u2, v1, v2);
         return SurfaceBounds { .u1 = u1, .u2 = u2, .v1 = v1, .v2 = v2 };
     }
+
+    /// @brief The nearest projection of packed points, one extrema setup serves all of them. Returns x y z
+    /// u v distance for every point, NaN where the projection fails.
+    static Float64Array projectPointBatch(const Geom_Surface* surface, const Float64Array& points)
+    {
+        auto pnts = unpackPoints(points);
+        std::vector<double> result(pnts.size() * 6, NO_VALUE);
+        GeomAPI_ProjectPointOnSurf projector;
+        initProjector(projector, surface);
+        for (size_t i = 0; i < pnts.size(); i++) {
+            projector.Perform(pnts[i]);
+            if (!projector.IsDone() || projector.NbPoints() == 0) {
+                continue;
+            }
+            gp_Pnt nearest = projector.NearestPoint();
+            double* out = result.data() + i * 6;
+            out[0] = nearest.X();
+            out[1] = nearest.Y();
+            out[2] = nearest.Z();
+            projector.LowerDistanceParameters(out[3], out[4]);
+            out[5] = projector.LowerDistance();
+        }
+        return typedArrayCopy<Float64Array>(result);
+    }
+
+    /// @brief parameters for packed points, u v of every point, NaN for points farther than maxDistance.
+    /// Every point goes through GeomLib_Tool::Parameters like the single point call, so the results agree
+    /// near seams and bounds too, only the marshalling is batched.
+    static Float64Array parametersBatch(const Geom_Surface* surface, const Float64Array& points, double maxDistance)
+    {
+        auto pnts = unpackPoints(points);
+        std::vector<double> result(pnts.size() * 2, NO_VALUE);
+        for (size_t i = 0; i < pnts.size(); i++) {
+            double u(0), v(0);
+            if (GeomLib_Tool::Parameters(surface, pnts[i], maxDistance, u, v)) {
+                result[i * 2] = u;
+                result[i * 2 + 1] = v;
+            }
+        }
+        return typedArrayCopy<Float64Array>(result);
+    }
+
+private:
+    static void initProjector(GeomAPI_ProjectPointOnSurf& projector, const Geom_Surface* surface)
+    {
+        double u1, u2, v1, v2;
+        surface->Bounds(u1, u2, v1, v2);
+        projector.Init(surface, u1, u2, v1, v2);
+    }
 };
 
 EMSCRIPTEN_BINDINGS(Geometry)
@@ -183,9 +324,13 @@ EMSCRIPTEN_BINDINGS(Geometry)
         .class_function("projectOrNearest", &Curve::projectOrNearest, allow_raw_pointers())
         .class_function("uniformAbscissaWithCount", &Curve::uniformAbscissaWithCount, allow_raw_pointers())
         .class_function("uniformAbscissaWithLength", &Curve::uniformAbscissaWithLength, allow_raw_pointers())
+        .class_function("uniformAbscissaBatchWithCount", &Curve::uniformAbscissaBatchWithCount)
+        .class_function("uniformAbscissaBatchWithLength", &Curve::uniformAbscissaBatchWithLength)
         .class_function("nearestExtremaCC", &Curve::nearestExtremaCC, allow_raw_pointers())
         .class_function("parameter", &Curve::parameter, allow_raw_pointers())
         .class_function("curveLength", &Curve::curveLength, allow_raw_pointers())
+        .class_function("projectOrNearestBatch", &Curve::projectOrNearestBatch, allow_raw_pointers())
+        .class_function("parameterBatch", &Curve::parameterBatch, allow_raw_pointers())
         .class_function("projects", &Curve::projects, allow_raw_pointers());
 
     value_object<SurfaceBounds>("SurfaceBounds")
@@ -200,5 +345,7 @@ EMSCRIPTEN_BINDINGS(Geometry)
         .class_function("isPlanar", &Surface::isPlanar, allow_raw_pointers())
         .class_function("parameters", &Surface::parameters, allow_raw_pointers())
         .class_function("nearestPoint", &Surface::nearestPoint, allow_raw_pointers())
-        .class_function("bounds", &Surface::bounds, allow_raw_pointers());
+        .class_function("bounds", &Surface::bounds, allow_raw_pointers())
+        .class_function("projectPointBatch", &Surface::projectPointBatch, allow_raw_pointers())
+        .class_function("parametersBatch", &Surface::parametersBatch, allow_raw_pointers());
 }
\ No newline at end of file
@@ -9,13 +9,21 @@
 #include <BRepLib_ToolTriangulatedShape.hxx>
 #include <BRepMesh_IncrementalMesh.hxx>
 #include <BRepTools.hxx>
+#include <BRep_Builder.hxx>
 #include <BRep_Tool.hxx>
-#include <GCPnts_TangentialDeflection.hxx>
+#include <BinTools.hxx>
+#include <GeomAbs_CurveType.hxx>
+#include <OSD_Parallel.hxx>
+#include <Poly_PolygonOnTriangulation.hxx>
 #include <Poly_Triangulation.hxx>
+#include <Precision.hxx>
+#include <Standard_Failure.hxx>
 #include <Standard_Handle.hxx>
 #include <TopExp.hxx>
 #include <TopExp_Explorer.hxx>
 #include <TopLoc_Location.hxx>
+#include <TopTools_IndexedDataMapOfShapeListOfShape.hxx>
+#include <TopTools_IndexedMapOfShape.hxx>
 #include <TopoDS.hxx>
 #include <TopoDS_Edge.hxx>
 #include <TopoDS_Face.hxx>
@@ -25,306 +33,1691 @@
 #include <gp_Pnt.hxx>
 #include <gp_Vec.hxx>
 
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <initializer_list>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <unordered_set>
+
+#include "bvh.hpp"
 #include "shared.hpp"
+#include "trace.hpp"
+#include "transform.hpp"
 #include "utils.hpp"
 
 using namespace emscripten;
 using namespace std;
 
-const double ANGLE_DEFLECTION = 0.2;
-
-void addPointToPosition(const gp_Pnt& pnt, std::optional<gp_Pnt>& prePnt, std::vector<float>& position)
-{
-    if (prePnt.has_value()) {
-        auto pre = prePnt.value();
-        position.push_back(pre.X());
-        position.push_back(pre.Y());
-        position.push_back(pre.Z());
-
-        position.push_back(pnt.X());
-        position.push_back(pnt.Y());
-        position.push_back(pnt.Z());
-    }
-    prePnt = pnt;
-}
-
-void pointByGCTangential(const TopoDS_Edge& edge, double lineDeflection, std::vector<float>& position)
+void pointByGCTangential(const TopoDS_Edge& edge, double lineDeflection, std::vector<gp_Pnt>& points)
 {
-    BRepAdaptor_Curve curve(edge);
-    GCPnts_TangentialDeflection pnts(curve, ANGLE_DEFLECTION, lineDeflection);
-
-    std::optional<gp_Pnt> prePnt = std::nullopt;
-    for (int i = 0; i < pnts.NbPoints(); i++) {
-        addPointToPosition(pnts.Value(i + 1), prePnt, position);
-    }
+    EdgeDiscretizer::discretize(edge, lineDeflection, points);
 }
 
-struct EdgeMeshData {
-    NumberArray position;
-    /// @brief start1,count1,start2,count2...
-    NumberArray group;
-    EdgeArray edges;
-};
-
-struct FaceMeshData {
-    NumberArray position;
-    NumberArray normal;
-    NumberArray uv;
-    NumberArray index;
-    /// @brief start1,count1,start2,count2...
-    NumberArray group;
-    FaceArray faces;
-};
-
-struct MeshData {
-    EdgeMeshData edgeMeshData;
-    FaceMeshData faceMeshData;
+struct MeshOptions {
+    /// @brief Writes every edge point once and connects them through EdgeMeshData::index,
+    /// the edge groups then count indices instead of points.
+    bool indexedEdges = false;
+    /// @brief Reorders the triangles of every face for the vertex cache and its nodes for fetch locality.
+    bool optimizeTriangleOrder = false;
+    /// @brief FaceMeshData::normal stays empty without it.
+    bool normals = true;
+    /// @brief FaceMeshData::uv stays empty without it, which also skips the UV bounds of every face.
+    bool uvs = true;
 };
 
 class EdgeMesher {
 public:
     double lineDeflection;
+    bool indexed;
     std::vector<float> position;
+    /// @brief Segment pairs into position, only filled when indexed.
+    std::vector<uint32_t> index;
     /// @brief start1,count1,start2,count2...
-    std::vector<size_t> group;
+    std::vector<uint32_t> group;
     std::vector<TopoDS_Edge> edges;
 
-    EdgeMesher(double lineDeflection)
+    EdgeMesher(double lineDeflection, bool indexed = false)
         : lineDeflection(lineDeflection)
+        , indexed(indexed)
     {
     }
 
-    void generateEdgeMesh(const TopoDS_Edge& edge, const Handle(Poly_Triangulation) & triangulation)
+    void reserve(size_t edgeCount)
     {
-        auto start = this->position.size() / 3;
+        this->edges.reserve(edgeCount);
+        this->slices.reserve(edgeCount);
+    }
 
-        if (triangulation.IsNull()) {
-            pointByGCTangential(edge, this->lineDeflection, this->position);
-        } else {
+    /// @brief Queues an edge, it uses its polygon on the triangulation when there is one and is sampled
+    /// with GCPnts_TangentialDeflection otherwise.
+    void addEdge(const TopoDS_Edge& edge, const Handle(Poly_Triangulation) & triangulation)
+    {
+        EdgeSlice slice;
+        slice.lineDeflection = lineDeflection;
+        if (!triangulation.IsNull()) {
             TopLoc_Location location;
-            Handle(Poly_PolygonOnTriangulation) polygon = BRep_Tool::PolygonOnTriangulation(edge, triangulation, location);
-            if (polygon.IsNull()) {
-                pointByGCTangential(edge, this->lineDeflection, this->position);
+            slice.polygon = BRep_Tool::PolygonOnTriangulation(edge, triangulation, location);
+            slice.triangulation = triangulation;
+            slice.trsf = location.Transformation();
+        }
+
+        this->edges.push_back(edge);
+        this->slices.push_back(std::move(slice));
+    }
+
+    /// @brief Queues an edge whose points are already known, it is not sampled again.
+    void addEdge(const TopoDS_Edge& edge, std::vector<gp_Pnt> points)
+    {
+        EdgeSlice slice;
+        slice.points = std::move(points);
+
+        this->edges.push_back(edge);
+        this->slices.push_back(std::move(slice));
+    }
+
+    /// @brief Counts the points of every edge first, so the buffers are allocated once and
+    /// each edge is written into its own slice in parallel.
+    void generateEdgeMeshes()
+    {
+        TRACE_SCOPE("EdgeMesher::generateEdgeMeshes");
+        OSD_Parallel::For(0, static_cast<int>(slices.size()), [this](int i) {
+            if (slices[i].polygon.IsNull() && slices[i].points.empty()) {
+                pointByGCTangential(edges[i], slices[i].lineDeflection, slices[i].points);
+            }
+        });
+
+        size_t pointCount = 0, indexCount = 0;
+        for (auto& slice : slices) {
+            slice.start = pointCount;
+            slice.indexStart = indexCount;
+            if (indexed) {
+                pointCount += nbPoints(slice);
+                indexCount += segmentPointCount(slice);
             } else {
-                auto trsf = location.Transformation();
-                pointByFaceTriangulation(polygon, triangulation, trsf);
+                pointCount += segmentPointCount(slice);
             }
         }
 
-        this->group.push_back(start);
-        this->group.push_back(this->position.size() / 3 - start);
+        this->position.resize(pointCount * 3);
+        this->index.resize(indexCount);
+        this->group.resize(slices.size() * 2);
+        OSD_Parallel::For(0, static_cast<int>(slices.size()), [this](int i) { generateEdgeMesh(i); });
+        TRACE_COUNT("edges", slices.size());
+        TRACE_COUNT("edgePoints", pointCount);
+    }
+
+private:
+    struct EdgeSlice {
+        Handle(Poly_PolygonOnTriangulation) polygon;
+        Handle(Poly_Triangulation) triangulation;
+        gp_Trsf trsf;
+        std::vector<gp_Pnt> points;
+        /// @brief The lineDeflection when the edge was added, a batch changes it per shape.
+        double lineDeflection = 0;
+        size_t start = 0;
+        size_t indexStart = 0;
+    };
+
+    std::vector<EdgeSlice> slices;
+
+    static size_t nbPoints(const EdgeSlice& slice)
+    {
+        return slice.polygon.IsNull() ? slice.points.size() : slice.polygon->NbNodes();
+    }
+
+    /// @brief Every segment is written as a pair of points, or a pair of indices when indexed.
+    static size_t segmentPointCount(const EdgeSlice& slice)
+    {
+        auto count = nbPoints(slice);
+        return count > 1 ? (count - 1) * 2 : 0;
+    }
+
+    void generateEdgeMesh(size_t i)
+    {
+        auto& slice = slices[i];
+        this->group[i * 2] = indexed ? slice.indexStart : slice.start;
+        this->group[i * 2 + 1] = segmentPointCount(slice);
+
+        float* out = this->position.data() + slice.start * 3;
+        if (indexed) {
+            forEachPoint(slice, [&out](const gp_Pnt& pnt) { out = writePoint(out, pnt); });
+            uint32_t* indexOut = this->index.data() + slice.indexStart;
+            for (size_t j = 1; j < nbPoints(slice); j++) {
+                *indexOut++ = slice.start + j - 1;
+                *indexOut++ = slice.start + j;
+            }
+        } else {
+            gp_Pnt prePnt;
+            bool isFirst = true;
+            forEachPoint(slice, [&](const gp_Pnt& pnt) {
+                if (!isFirst) {
+                    out = writePoint(writePoint(out, prePnt), pnt);
+                }
+                prePnt = pnt;
+                isFirst = false;
+            });
+        }
     }
 
-    void pointByFaceTriangulation(const Handle_Poly_PolygonOnTriangulation& polygon,
-        const Handle_Poly_Triangulation& triangulation, const gp_Trsf& transform)
+    template <typename Callback>
+    void forEachPoint(const EdgeSlice& slice, Callback&& callback)
     {
-        std::optional<gp_Pnt> prePnt = std::nullopt;
-        auto nodeIndex = polygon->Nodes();
+        if (slice.polygon.IsNull()) {
+            for (auto& pnt : slice.points) {
+                callback(pnt);
+            }
+            return;
+        }
+
+        MeshTransform transform(slice.trsf);
+        const TColStd_Array1OfInteger& nodeIndex = slice.polygon->Nodes();
         for (auto i = nodeIndex.Lower(); i <= nodeIndex.Upper(); i++) {
-            auto pnt = triangulation->Node(nodeIndex[i]).Transformed(transform);
-            addPointToPosition(pnt, prePnt, this->position);
+            callback(transform.point(slice.triangulation->Node(nodeIndex[i])));
         }
     }
+
+    static float* writePoint(float* out, const gp_Pnt& pnt)
+    {
+        *out++ = pnt.X();
+        *out++ = pnt.Y();
+        *out++ = pnt.Z();
+        return out;
+    }
 };
 
+/// @brief Whether corner k of the triangle repeats an earlier corner. A degenerate triangle is listed
+/// once per distinct vertex, so the adjacency lists and the live triangle counts stay in step.
+static bool isRepeatedCorner(const uint32_t* triangle, int k)
+{
+    return (k > 0 && triangle[k] == triangle[0]) || (k == 2 && triangle[2] == triangle[1]);
+}
+
+/// @brief Reorders the triangles for the post transform vertex cache with Forsyth's linear speed
+/// algorithm. The indices address vertexCount nodes starting at vertexBase.
+static void optimizeVertexCache(uint32_t* indices, size_t indexCount, uint32_t vertexBase, size_t vertexCount)
+{
+    static constexpr int CACHE_SIZE = 32;
+    size_t triangleCount = indexCount / 3;
+    if (triangleCount < 2) {
+        return;
+    }
+
+    static constexpr uint32_t VALENCE_TABLE_SIZE = 32;
+    static const auto cacheTable = [] {
+        std::array<float, CACHE_SIZE> scores;
+        for (int i = 0; i < CACHE_SIZE; i++) {
+            scores[i] = i < 3 ? 0.75f : std::pow(1.0f - float(i - 3) / float(CACHE_SIZE - 3), 1.5f);
+        }
+        return scores;
+    }();
+    static const auto valenceTable = [] {
+        std::array<float, VALENCE_TABLE_SIZE> scores;
+        for (uint32_t i = 0; i < VALENCE_TABLE_SIZE; i++) {
+            scores[i] = i == 0 ? 0 : 2.0f / std::sqrt(float(i));
+        }
+        return scores;
+    }();
+    auto vertexScore = [](int position, uint32_t remaining) {
+        if (remaining == 0) {
+            return -1.0f;
+        }
+        float valence = remaining < VALENCE_TABLE_SIZE ? valenceTable[remaining] : 2.0f / std::sqrt(float(remaining));
+        return (position < 0 ? 0.0f : cacheTable[position]) + valence;
+    };
+
+    // the triangles of every vertex, as offsets into one shared list
+    std::vector<uint32_t> remaining(vertexCount, 0), offsets(vertexCount + 1, 0), adjacency(indexCount);
+    for (size_t i = 0; i < indexCount; i++) {
+        if (!isRepeatedCorner(indices + i - i % 3, i % 3)) {
+            offsets[indices[i] - vertexBase + 1]++;
+        }
+    }
+    for (size_t v = 0; v < vertexCount; v++) {
+        offsets[v + 1] += offsets[v];
+    }
+    for (size_t i = 0; i < indexCount; i++) {
+        if (!isRepeatedCorner(indices + i - i % 3, i % 3)) {
+            auto v = indices[i] - vertexBase;
+            adjacency[offsets[v] + remaining[v]++] = i / 3;
+        }
+    }
+
+    std::vector<int> cachePosition(vertexCount, -1);
+    std::vector<float> score(vertexCount);
+    for (size_t v = 0; v < vertexCount; v++) {
+        score[v] = vertexScore(-1, remaining[v]);
+    }
+    std::vector<float> triangleScore(triangleCount);
+    std::vector<bool> emitted(triangleCount, false);
+    for (size_t t = 0; t < triangleCount; t++) {
+        auto* tri = indices + t * 3;
+        triangleScore[t] = score[tri[0] - vertexBase] + score[tri[1] - vertexBase] + score[tri[2] - vertexBase];
+    }
+
+    std::vector<uint32_t> output(indexCount);
+    std::vector<uint32_t> cache, nextCache;
+    cache.reserve(CACHE_SIZE + 3);
+    nextCache.reserve(CACHE_SIZE + 3);
+    size_t scanCursor = 0;
+    int best = -1;
+    for (size_t emittedCount = 0; emittedCount < triangleCount; emittedCount++) {
+        if (best < 0) {
+            // the cached vertices have no triangles left, continue with the next island
+            while (emitted[scanCursor]) {
+                scanCursor++;
+            }
+            best = static_cast<int>(scanCursor);
+        }
+
+        auto* tri = indices + best * 3;
+        emitted[best] = true;
+        nextCache.clear();
+        for (int k = 0; k < 3; k++) {
+            auto v = tri[k] - vertexBase;
+            output[emittedCount * 3 + k] = tri[k];
+            if (isRepeatedCorner(tri, k)) {
+                continue;
+            }
+            nextCache.push_back(v);
+            auto* begin = adjacency.data() + offsets[v];
+            auto* end = begin + remaining[v];
+            std::remove(begin, end, static_cast<uint32_t>(best));
+            remaining[v]--;
+        }
+        auto corners = static_cast<std::ptrdiff_t>(nextCache.size());
+        for (auto v : cache) {
+            if (std::find(nextCache.begin(), nextCache.begin() + corners, v) == nextCache.begin() + corners) {
+                nextCache.push_back(v);
+            }
+        }
+        for (size_t i = 0; i < nextCache.size(); i++) {
+            auto position = i < CACHE_SIZE ? static_cast<int>(i) : -1;
+            cachePosition[nextCache[i]] = position;
+            score[nextCache[i]] = vertexScore(position, remaining[nextCache[i]]);
+        }
+
+        // only the triangles around the cached and the evicted vertices change their score
+        best = -1;
+        float bestScore = -1;
+        for (auto v : nextCache) {
+            for (uint32_t j = 0; j < remaining[v]; j++) {
+                auto t = adjacency[offsets[v] + j];
+                auto* other = indices + t * 3;
+                triangleScore[t] = score[other[0] - vertexBase] + score[other[1] - vertexBase] + score[other[2] - vertexBase];
+                if (cachePosition[v] >= 0 && triangleScore[t] > bestScore) {
+                    bestScore = triangleScore[t];
+                    best = static_cast<int>(t);
+                }
+            }
+        }
+        if (nextCache.size() > CACHE_SIZE) {
+            nextCache.resize(CACHE_SIZE);
+        }
+        std::swap(cache, nextCache);
+    }
+
+    std::copy(output.begin(), output.end(), indices);
+}
+
+/// @brief Renumbers the nodes in the order the triangles first use them, so the vertex fetch walks the
+/// buffers forward. Nodes no triangle uses move to the end of the range, null attributes are skipped.
+static void optimizeVertexFetch(uint32_t* indices, size_t indexCount, uint32_t vertexBase, size_t vertexCount,
+    std::initializer_list<std::pair<float*, int>> attributes)
+{
+    static constexpr uint32_t UNUSED = std::numeric_limits<uint32_t>::max();
+    std::vector<uint32_t> remap(vertexCount, UNUSED);
+    uint32_t next = 0;
+    for (size_t i = 0; i < indexCount; i++) {
+        auto& target = remap[indices[i] - vertexBase];
+        if (target == UNUSED) {
+            target = next++;
+        }
+        indices[i] = vertexBase + target;
+    }
+    for (auto& target : remap) {
+        if (target == UNUSED) {
+            target = next++;
+        }
+    }
+
+    std::vector<float> copy;
+    for (auto [data, components] : attributes) {
+        if (data == nullptr) {
+            continue;
+        }
+        float* begin = data + size_t(vertexBase) * components;
+        copy.assign(begin, begin + vertexCount * components);
+        for (size_t v = 0; v < vertexCount; v++) {
+            std::copy_n(copy.data() + v * components, components, begin + size_t(remap[v]) * components);
+        }
+    }
+}
+
 class FaceMesher {
 public:
     std::vector<float> position;
     std::vector<float> normal;
     std::vector<float> uv;
-    std::vector<size_t> index;
+    std::vector<uint32_t> index;
     /// @brief start1,count1,start2,count2...
-    std::vector<size_t> group;
+    std::vector<uint32_t> group;
     std::vector<TopoDS_Face> faces;
 
-    void generateFaceMesh(const TopoDS_Face& face, const Handle(Poly_Triangulation) & handlePoly, const gp_Trsf& trsf)
+    explicit FaceMesher(const MeshOptions& options = MeshOptions {})
+        : optimizeOrder(options.optimizeTriangleOrder)
+        , withNormals(options.normals)
+        , withUvs(options.uvs)
+    {
+    }
+
+    void reserve(size_t faceCount)
+    {
+        this->faces.reserve(faceCount);
+        this->slices.reserve(faceCount);
+    }
+
+    /// @brief Queues a face, its triangulation is written into the buffers by generateFaceMeshes.
+    void addFace(const TopoDS_Face& face, const Handle(Poly_Triangulation) & handlePoly, const gp_Trsf& trsf)
+    {
+        this->faces.push_back(face);
+        this->slices.push_back(FaceSlice { handlePoly, trsf, nodeCount, indexCount });
+        if (!handlePoly.IsNull()) {
+            nodeCount += handlePoly->NbNodes();
+            indexCount += handlePoly->NbTriangles() * 3;
+        }
+    }
+
+    /// @brief The number of nodes queued so far, the node offset of the next face.
+    size_t nodeSize() const
+    {
+        return nodeCount;
+    }
+
+    /// @brief The node and index offsets of every face are an exclusive prefix sum over the queued faces,
+    /// so the buffers are allocated once and each face is written into its own slice in parallel.
+    void generateFaceMeshes()
+    {
+        TRACE_SCOPE("FaceMesher::generateFaceMeshes");
+        this->position.resize(nodeCount * 3);
+        this->normal.resize(withNormals ? nodeCount * 3 : 0);
+        this->uv.resize(withUvs ? nodeCount * 2 : 0);
+        this->index.resize(indexCount);
+        this->group.resize(slices.size() * 2);
+
+        if (withNormals) {
+            TRACE_SCOPE("FaceMesher::computeNormals");
+            computeNormals();
+        }
+        OSD_Parallel::For(0, static_cast<int>(slices.size()), [this](int i) { generateFaceMesh(i); });
+        TRACE_COUNT("faces", slices.size());
+        TRACE_COUNT("triangles", indexCount / 3);
+        TRACE_COUNT("meshBytes", (position.size() + normal.size() + uv.size() + index.size()) * 4);
+    }
+
+private:
+    struct FaceSlice {
+        Handle(Poly_Triangulation) handlePoly;
+        gp_Trsf trsf;
+        size_t nodeStart;
+        size_t indexStart;
+    };
+
+    bool optimizeOrder;
+    bool withNormals;
+    bool withUvs;
+    std::vector<FaceSlice> slices;
+    size_t nodeCount = 0;
+    size_t indexCount = 0;
+
+    /// @brief Located instances of a face share one triangulation, so the normals are computed once per
+    /// triangulation before the parallel fill, which then only reads from them.
+    void computeNormals()
+    {
+        std::vector<size_t> unique;
+        std::unordered_set<const Poly_Triangulation*> visited;
+        for (size_t i = 0; i < slices.size(); i++) {
+            if (!slices[i].handlePoly.IsNull() && visited.insert(slices[i].handlePoly.get()).second) {
+                unique.push_back(i);
+            }
+        }
+
+        OSD_Parallel::For(0, static_cast<int>(unique.size()), [this, &unique](int i) {
+            BRepLib_ToolTriangulatedShape::ComputeNormals(faces[unique[i]], slices[unique[i]].handlePoly);
+        });
+    }
+
+    void generateFaceMesh(size_t i)
     {
-        if (handlePoly.IsNull()) {
+        auto& slice = slices[i];
+        this->group[i * 2] = slice.indexStart;
+        this->group[i * 2 + 1] = slice.handlePoly.IsNull() ? 0 : slice.handlePoly->NbTriangles() * 3;
+        if (slice.handlePoly.IsNull()) {
             return;
         }
 
-        bool isMirrod = trsf.VectorialPart().Determinant() < 0;
+        const TopoDS_Face& face = faces[i];
+        bool isMirrod = slice.trsf.VectorialPart().Determinant() < 0;
         auto orientation = face.Orientation();
-        auto groupStart = this->index.size();
-        auto indexStart = this->position.size() / 3;
 
-        this->fillIndex(indexStart, handlePoly, orientation);
-        this->fillPosition(trsf, handlePoly);
-        this->fillNormal(trsf, face, handlePoly, (orientation == TopAbs_REVERSED) ^ isMirrod);
-        this->fillUv(face, handlePoly);
+        this->fillIndex(slice, orientation);
+        this->fillPosition(slice);
+        if (withNormals) {
+            this->fillNormal(slice, (orientation == TopAbs_REVERSED) ^ isMirrod);
+        }
+        if (withUvs) {
+            this->fillUv(face, slice);
+        }
+        if (optimizeOrder) {
+            this->optimizeFace(slice);
+        }
+    }
+
+    /// @brief Reorders the triangles and then the nodes of one face inside its own ranges, the groups stay valid.
+    void optimizeFace(const FaceSlice& slice)
+    {
+        size_t indexCount = slice.handlePoly->NbTriangles() * 3;
+        size_t nodeCount = slice.handlePoly->NbNodes();
+        uint32_t* indices = this->index.data() + slice.indexStart;
+        optimizeVertexCache(indices, indexCount, slice.nodeStart, nodeCount);
+        optimizeVertexFetch(indices, indexCount, slice.nodeStart, nodeCount,
+            { { this->position.data(), 3 }, { withNormals ? this->normal.data() : nullptr, 3 },
+                { withUvs ? this->uv.data() : nullptr, 2 } });
+    }
 
-        this->group.push_back(groupStart);
-        this->group.push_back(this->index.size() - groupStart);
+    /// @brief The nodes of a triangulation as packed x y z, Poly_ArrayOfNodes stores gp_Pnt or gp_Vec3f
+    /// contiguously. nullptr when the layout is not the expected one.
+    template <typename T>
+    static const T* packedNodes(const Poly_ArrayOfNodes& nodes, size_t elementSize)
+    {
+        const NCollection_AliasedArray<>& array = nodes;
+        if (array.Length() == 0 || array.Stride() != static_cast<int>(elementSize)) {
+            return nullptr;
+        }
+        return reinterpret_cast<const T*>(&array.Value<Standard_Byte>(0));
     }
 
-    void fillPosition(const gp_Trsf& transform, const Handle(Poly_Triangulation) & handlePoly)
+    void fillPosition(const FaceSlice& slice)
     {
-        for (int index = 0; index < handlePoly->NbNodes(); index++) {
-            auto pnt = handlePoly->Node(index + 1).Transformed(transform);
-            this->position.push_back(pnt.X());
-            this->position.push_back(pnt.Y());
-            this->position.push_back(pnt.Z());
+        float* out = this->position.data() + slice.nodeStart * 3;
+        MeshTransform transform(slice.trsf);
+        const Poly_ArrayOfNodes& nodes = slice.handlePoly->InternalNodes();
+        size_t count = slice.handlePoly->NbNodes();
+        if (nodes.IsDoublePrecision()) {
+            if (auto packed = packedNodes<double>(nodes, sizeof(gp_Pnt))) {
+                transform.points(packed, count, out);
+                return;
+            }
+        } else if (auto packed = packedNodes<float>(nodes, sizeof(gp_Vec3f))) {
+            transform.points(packed, count, out);
+            return;
+        }
+
+        for (int index = 0; index < slice.handlePoly->NbNodes(); index++) {
+            auto pnt = transform.point(slice.handlePoly->Node(index + 1));
+            *out++ = pnt.X();
+            *out++ = pnt.Y();
+            *out++ = pnt.Z();
         }
     }
 
-    void fillNormal(const gp_Trsf& transform, const TopoDS_Face& face, const Handle(Poly_Triangulation) & handlePoly,
-        bool shouldReverse)
+    void fillNormal(const FaceSlice& slice, bool shouldReverse)
     {
-        BRepLib_ToolTriangulatedShape::ComputeNormals(face, handlePoly);
-        for (int index = 0; index < handlePoly->NbNodes(); index++) {
-            auto normal = handlePoly->Normal(index + 1);
+        float* out = this->normal.data() + slice.nodeStart * 3;
+        if (slice.handlePoly->HasNormals()) {
+            MeshTransform transform(slice.trsf);
+            const NCollection_Array1<gp_Vec3f>& normals = slice.handlePoly->InternalNormals();
+            transform.normals(normals.First().GetData(), normals.Length(), shouldReverse, out);
+            return;
+        }
+
+        for (int index = 0; index < slice.handlePoly->NbNodes(); index++) {
+            auto normal = slice.handlePoly->Normal(index + 1);
             if (shouldReverse) {
                 normal.Reverse();
             }
-            normal = normal.Transformed(transform);
-            this->normal.push_back(normal.X());
-            this->normal.push_back(normal.Y());
-            this->normal.push_back(normal.Z());
+            normal = normal.Transformed(slice.trsf);
+            *out++ = normal.X();
+            *out++ = normal.Y();
+            *out++ = normal.Z();
         }
     }
 
-    void fillIndex(size_t indexStart, const Handle(Poly_Triangulation) & handlePoly,
-        const TopAbs_Orientation& orientation)
+    void fillIndex(const FaceSlice& slice, const TopAbs_Orientation& orientation)
     {
-        for (int index = 0; index < handlePoly->NbTriangles(); index++) {
+        uint32_t* out = this->index.data() + slice.indexStart;
+        for (int index = 0; index < slice.handlePoly->NbTriangles(); index++) {
             auto v1(1), v2(2), v3(3);
             if (orientation == TopAbs_REVERSED) {
                 v2 = 3;
                 v3 = 2;
             }
 
-            auto triangle = handlePoly->Triangle(index + 1);
-            this->index.push_back(triangle.Value(v1) - 1 + indexStart);
-            this->index.push_back(triangle.Value(v2) - 1 + indexStart);
-            this->index.push_back(triangle.Value(v3) - 1 + indexStart);
+            auto triangle = slice.handlePoly->Triangle(index + 1);
+            *out++ = triangle.Value(v1) - 1 + slice.nodeStart;
+            *out++ = triangle.Value(v2) - 1 + slice.nodeStart;
+            *out++ = triangle.Value(v3) - 1 + slice.nodeStart;
         }
     }
 
-    void fillUv(const TopoDS_Face& face, const Handle(Poly_Triangulation) & handlePoly)
+    void fillUv(const TopoDS_Face& face, const FaceSlice& slice)
     {
         double aUmin, aUmax, aVmin, aVmax, dUmax, dVmax;
         BRepTools::UVBounds(face, aUmin, aUmax, aVmin, aVmax);
         dUmax = (aUmax - aUmin);
         dVmax = (aVmax - aVmin);
-        for (int index = 0; index < handlePoly->NbNodes(); index++) {
-            auto uv = handlePoly->UVNode(index + 1);
-            this->uv.push_back((uv.X() - aUmin) / dUmax);
-            this->uv.push_back((uv.Y() - aVmin) / dVmax);
+        float* out = this->uv.data() + slice.nodeStart * 2;
+        for (int index = 0; index < slice.handlePoly->NbNodes(); index++) {
+            auto uv = slice.handlePoly->UVNode(index + 1);
+            *out++ = (uv.X() - aUmin) / dUmax;
+            *out++ = (uv.Y() - aVmin) / dVmax;
         }
     }
 };
 
-class Mesher {
-    TopoDS_Shape shape;
-    double lineDeflection;
+EMSCRIPTEN_DECLARE_VAL_TYPE(IndexArray)
+
+/// @brief The FaceMesher buffers in a compact encoding for transfer and GPU upload, about 14 instead of
+/// 32 bytes per vertex. Decode on the GPU with normalized attributes:
+///   position: uint16 xyz, p = positionOffset + q / 65535 * positionScale
+///   normal:   int16 octahedral xy, n = octDecode(q / 32767)
+///   uv:       uint16 uv, t = uvOffset + q / 65535 * uvScale
+///   index:    Uint16Array when the nodes fit into 16 bits, Uint32Array otherwise
+/// group keeps the face ranges of FaceMeshData.
+class QuantizedFaceMesh {
+    std::vector<uint16_t> position;
+    std::vector<int16_t> normal;
+    std::vector<uint16_t> uv;
+    std::vector<uint16_t> index16;
+    std::vector<uint32_t> index32;
+    std::vector<uint32_t> group;
+    std::vector<float> positionBounds; // offset xyz, scale xyz
+    std::vector<float> uvBounds; // offset uv, scale uv
 
 public:
-    Mesher(const TopoDS_Shape& shape, double lineDeflection)
-        : shape(shape)
+    explicit QuantizedFaceMesh(const FaceMesher& mesher)
+        : group(mesher.group)
     {
-        this->lineDeflection = boundingBoxRatio(shape, lineDeflection);
+        size_t nodeCount = mesher.position.size() / 3;
+        positionBounds = quantize(mesher.position, 3, position);
+        uvBounds = quantize(mesher.uv, 2, uv);
+
+        // empty when the mesh was made without normals
+        size_t normalCount = mesher.normal.size() / 3;
+        normal.resize(normalCount * 2);
+        OSD_Parallel::For(0, static_cast<int>(normalCount), [this, &mesher](int i) {
+            encodeOctahedral(mesher.normal.data() + i * 3, normal.data() + i * 2);
+        });
+
+        if (nodeCount <= 0x10000) {
+            index16.assign(mesher.index.begin(), mesher.index.end());
+        } else {
+            index32 = mesher.index;
+        }
     }
 
-    NumberArray edgesMeshPosition()
+    Uint16Array getPosition() const
     {
-        std::vector<float> position;
-        TopTools_IndexedMapOfShape edgeMap;
-        TopExp::MapShapes(shape, TopAbs_EDGE, edgeMap);
-        for (TopTools_IndexedMapOfShape::Iterator anIt(edgeMap); anIt.More(); anIt.Next()) {
-            TopoDS_Edge edge = TopoDS::Edge(anIt.Value());
-            pointByGCTangential(edge, this->lineDeflection, position);
-        }
+        return typedArrayView<Uint16Array>(position);
+    }
 
-        return NumberArray(val::array(position));
+    Int16Array getNormal() const
+    {
+        return typedArrayView<Int16Array>(normal);
     }
 
-    MeshData mesh()
+    Uint16Array getUv() const
     {
-        BRepMesh_IncrementalMesh mesh(shape, lineDeflection, true, ANGLE_DEFLECTION, true);
+        return typedArrayView<Uint16Array>(uv);
+    }
 
-        std::unordered_map<TopoDS_Face, Handle(Poly_Triangulation)> facePolyMap;
-        auto faceMeshData = meshFaces(facePolyMap);
-        auto edgeMeshData = meshEdges(facePolyMap);
+    IndexArray getIndex() const
+    {
+        return index32.empty() ? IndexArray(typedArrayView<Uint16Array>(index16)) : IndexArray(typedArrayView<Uint32Array>(index32));
+    }
 
-        return MeshData { edgeMeshData, faceMeshData };
+    Uint32Array getGroup() const
+    {
+        return typedArrayView<Uint32Array>(group);
     }
 
-    EdgeMeshData meshEdges(std::unordered_map<TopoDS_Face, Handle_Poly_Triangulation>& facePolyMap)
+    Float32Array getPositionBounds() const
     {
-        EdgeMesher mesher(lineDeflection);
-        TopTools_IndexedDataMapOfShapeListOfShape mapEF;
-        TopExp::MapShapesAndAncestors(shape, TopAbs_EDGE, TopAbs_FACE, mapEF);
-        for (int ie = 1; ie <= mapEF.Extent(); ie++) {
-            const TopoDS_Edge& aEdge = TopoDS::Edge(mapEF.FindKey(ie));
-            mesher.edges.push_back(aEdge);
+        return typedArrayView<Float32Array>(positionBounds);
+    }
 
-            const TopTools_ListOfShape& aFaces = mapEF(ie);
-            if (aFaces.Extent() < 1) {
-                mesher.generateEdgeMesh(aEdge, nullptr);
-            } else {
-                const TopoDS_Face& face = TopoDS::Face(aFaces.First());
-                auto it = facePolyMap.find(face);
-                if (it != facePolyMap.end()) {
-                    mesher.generateEdgeMesh(aEdge, it->second);
-                } else {
-                    mesher.generateEdgeMesh(aEdge, nullptr);
-                }
+    Float32Array getUvBounds() const
+    {
+        return typedArrayView<Float32Array>(uvBounds);
+    }
+
+private:
+    /// @brief Maps every component to 16 bits over its range and returns the offsets followed by the scales.
+    static std::vector<float> quantize(const std::vector<float>& values, int components, std::vector<uint16_t>& out)
+    {
+        std::vector<float> bounds(components * 2, 0);
+        for (int c = 0; c < components; c++) {
+            float min = std::numeric_limits<float>::max(), max = std::numeric_limits<float>::lowest();
+            for (size_t i = c; i < values.size(); i += components) {
+                min = std::min(min, values[i]);
+                max = std::max(max, values[i]);
+            }
+            if (min <= max) {
+                bounds[c] = min;
+                bounds[components + c] = max - min;
             }
         }
 
-        return EdgeMeshData { NumberArray(val::array(mesher.position)), NumberArray(val::array(mesher.group)),
-            EdgeArray(val::array(mesher.edges)) };
+        out.resize(values.size());
+        OSD_Parallel::For(0, static_cast<int>(values.size()), [&](int i) {
+            float scale = bounds[components + i % components];
+            float t = scale > 0 ? (values[i] - bounds[i % components]) / scale : 0;
+            out[i] = static_cast<uint16_t>(std::lround(std::clamp(t, 0.0f, 1.0f) * 65535));
+        });
+        return bounds;
     }
 
-    FaceMeshData meshFaces(std::unordered_map<TopoDS_Face, Handle_Poly_Triangulation>& facePolyMap)
+    static void encodeOctahedral(const float* normal, int16_t* out)
     {
-        FaceMesher mesher;
-        TopTools_IndexedMapOfShape faceMap;
-        TopExp::MapShapes(shape, TopAbs_FACE, faceMap);
-        for (TopTools_IndexedMapOfShape::Iterator anIt(faceMap); anIt.More(); anIt.Next()) {
-            auto face = TopoDS::Face(anIt.Value());
-            mesher.faces.push_back(face);
-            TopLoc_Location location;
-            auto handlePoly = BRep_Tool::Triangulation(face, location);
-            if (!handlePoly.IsNull()) {
-                auto trsf = location.Transformation();
-                mesher.generateFaceMesh(face, handlePoly, trsf);
-                facePolyMap[face] = handlePoly;
-            }
+        float length = std::abs(normal[0]) + std::abs(normal[1]) + std::abs(normal[2]);
+        float x = length > 0 ? normal[0] / length : 0;
+        float y = length > 0 ? normal[1] / length : 0;
+        if (normal[2] < 0) {
+            float foldedX = (1 - std::abs(y)) * (x >= 0 ? 1 : -1);
+            y = (1 - std::abs(x)) * (y >= 0 ? 1 : -1);
+            x = foldedX;
         }
+        out[0] = static_cast<int16_t>(std::lround(std::clamp(x, -1.0f, 1.0f) * 32767));
+        out[1] = static_cast<int16_t>(std::lround(std::clamp(y, -1.0f, 1.0f) * 32767));
+    }
+};
+
+/// @brief Typed array views over the buffers of a Mesher, the data stays in the wasm heap.
+/// The views are detached when the heap grows, so consume or copy each of them before calling into wasm again.
+/// The buffers are shared with the Mesher, they stay valid until both the Mesher has released them and the
+/// MeshData is deleted, and a later mesh call writes new buffers instead of reusing these.
+struct EdgeMeshData {
+    std::shared_ptr<const EdgeMesher> mesher;
 
-        return FaceMeshData { NumberArray(val::array(mesher.position)), NumberArray(val::array(mesher.normal)),
-            NumberArray(val::array(mesher.uv)), NumberArray(val::array(mesher.index)),
-            NumberArray(val::array(mesher.group)), FaceArray(val::array(mesher.faces)) };
+    Float32Array position() const
+    {
+        return typedArrayView<Float32Array>(mesher->position);
     }
 
-    ~Mesher()
+    Uint32Array index() const
     {
-        BRepTools::Clean(shape, true);
+        return typedArrayView<Uint32Array>(mesher->index);
+    }
+
+    Uint32Array group() const
+    {
+        return typedArrayView<Uint32Array>(mesher->group);
+    }
+
+    EdgeArray edges() const
+    {
+        TRACE_SCOPE("EdgeMeshData::edges");
+        return EdgeArray(val::array(mesher->edges));
     }
 };
 
-EMSCRIPTEN_BINDINGS(Mesher)
+struct FaceMeshData {
+    std::shared_ptr<const FaceMesher> mesher;
+
+    Float32Array position() const
+    {
+        return typedArrayView<Float32Array>(mesher->position);
+    }
+
+    Float32Array normal() const
+    {
+        return typedArrayView<Float32Array>(mesher->normal);
+    }
+
+    Float32Array uv() const
+    {
+        return typedArrayView<Float32Array>(mesher->uv);
+    }
+
+    Uint32Array index() const
+    {
+        return typedArrayView<Uint32Array>(mesher->index);
+    }
+
+    Uint32Array group() const
+    {
+        return typedArrayView<Uint32Array>(mesher->group);
+    }
+
+    FaceArray faces() const
+    {
+        TRACE_SCOPE("FaceMeshData::faces");
+        return FaceArray(val::array(mesher->faces));
+    }
+
+    /// @brief A compact copy of the buffers, it stays valid after the MeshData is deleted.
+    QuantizedFaceMesh quantize() const
+    {
+        return QuantizedFaceMesh(*mesher);
+    }
+};
+
+struct MeshData {
+    EdgeMeshData edgeMeshData;
+    FaceMeshData faceMeshData;
+};
+
+struct MeshBvhHit {
+    /// @brief The slot of the face or edge in FaceMeshData::faces or EdgeMeshData::edges.
+    int index;
+    double distance;
+    Vector3 point;
+};
+
+/// @brief Indexes the triangles and edge segments of the MeshData for picking and snapping. It copies what
+/// it needs, so it stays valid after the MeshData is deleted.
+MeshBvh buildMeshBvh(const MeshData& data)
 {
-    class_<Mesher>("Mesher")
-        .constructor<TopoDS_Shape, double>()
-        .function("mesh", &Mesher::mesh)
-        .function("edgesMeshPosition", &Mesher::edgesMeshPosition);
+    MeshBvh bvh;
+    const FaceMesher& faces = *data.faceMeshData.mesher;
+    bvh.buildFaces(faces.position.data(), faces.index.data(), faces.group.data(), faces.group.size() / 2);
+    const EdgeMesher& edges = *data.edgeMeshData.mesher;
+    bvh.buildEdges(edges.position.data(), edges.indexed ? edges.index.data() : nullptr, edges.group.data(), edges.group.size() / 2);
+    return bvh;
+}
 
-    class_<EdgeMeshData>("EdgeMeshData")
-        .property("position", &EdgeMeshData::position)
-        .property("group", &EdgeMeshData::group)
-        .property("edges", &EdgeMeshData::edges);
+static std::optional<MeshBvhHit> toMeshBvhHit(const std::optional<BvhHit>& hit)
+{
+    if (!hit.has_value()) {
+        return std::nullopt;
+    }
+    return MeshBvhHit { .index = static_cast<int>(hit->index),
+        .distance = hit->distance,
+        .point = Vector3 { hit->point[0], hit->point[1], hit->point[2] } };
+}
 
-    class_<FaceMeshData>("FaceMeshData")
-        .property("position", &FaceMeshData::position)
-        .property("normal", &FaceMeshData::normal)
-        .property("uv", &FaceMeshData::uv)
-        .property("index", &FaceMeshData::index)
-        .property("group", &FaceMeshData::group)
-        .property("faces", &FaceMeshData::faces);
+std::optional<MeshBvhHit> raycastMeshBvh(const MeshBvh& bvh, const Vector3& origin, const Vector3& direction, double maxDistance)
+{
+    float o[3] = { float(origin.x), float(origin.y), float(origin.z) };
+    float d[3] = { float(direction.x), float(direction.y), float(direction.z) };
+    return toMeshBvhHit(bvh.raycast(o, d, float(maxDistance)));
+}
 
-    class_<MeshData>("MeshData")
-        .property("edgeMeshData", &MeshData::edgeMeshData)
-        .property("faceMeshData", &MeshData::faceMeshData);
+std::optional<MeshBvhHit> nearestEdgeMeshBvh(const MeshBvh& bvh, const Vector3& point, double maxDistance)
+{
+    float p[3] = { float(point.x), float(point.y), float(point.z) };
+    return toMeshBvhHit(bvh.nearestEdge(p, float(maxDistance)));
+}
+
+EMSCRIPTEN_DECLARE_VAL_TYPE(MeshDataArray)
+
+/// @brief Keeps the triangulation of every meshed face keyed by its TShape. Faces that an operation
+/// passes through unchanged keep their TShape, so their triangles are put back before meshing and
+/// BRepMesh only triangulates the new or modified faces. The capacity is a number of triangles, and
+/// prune drops the faces no shape refers to anymore.
+class MeshCache {
+    static constexpr size_t DEFAULT_CAPACITY = 1000000;
+
+    struct EdgePolygons {
+        Handle(Poly_PolygonOnTriangulation) polygon;
+        /// @brief The reversed side of a seam edge, null otherwise.
+        Handle(Poly_PolygonOnTriangulation) seamPolygon;
+    };
+
+    struct Entry {
+        double deflection;
+        Handle(Poly_Triangulation) triangulation;
+        /// @brief In the TopExp::MapShapes order of the face edges.
+        std::vector<EdgePolygons> edges;
+    };
+
+    struct TriangleWeight {
+        size_t operator()(const Entry& entry) const
+        {
+            return entry.triangulation->NbTriangles();
+        }
+    };
+
+    using Entries = LruCache<Handle(TopoDS_TShape), Entry, std::hash<Handle(TopoDS_TShape)>, TriangleWeight>;
+
+    static Entries& entries()
+    {
+        static Entries cache(DEFAULT_CAPACITY);
+        return cache;
+    }
+
+    static size_t& restoredFaces()
+    {
+        static size_t count = 0;
+        return count;
+    }
+
+public:
+    /// @brief Reattaches the cached triangulations meshed with a deflection no coarser than the requested one.
+    static void restore(const TopoDS_Shape& shape, double deflection)
+    {
+        BRep_Builder builder;
+        TopTools_IndexedMapOfShape faceMap;
+        TopExp::MapShapes(shape, TopAbs_FACE, faceMap);
+        for (TopTools_IndexedMapOfShape::Iterator anIt(faceMap); anIt.More(); anIt.Next()) {
+            auto entry = entries().find(anIt.Value().TShape());
+            if (entry == nullptr || entry->deflection > deflection) {
+                continue;
+            }
+
+            auto face = TopoDS::Face(anIt.Value().Located(TopLoc_Location()));
+            TopLoc_Location location;
+            if (!BRep_Tool::Triangulation(face, location).IsNull()) {
+                continue;
+            }
+
+            TopTools_IndexedMapOfShape edgeMap;
+            TopExp::MapShapes(face, TopAbs_EDGE, edgeMap);
+            if (edgeMap.Extent() != static_cast<int>(entry->edges.size())) {
+                continue;
+            }
+
+            builder.UpdateFace(face, entry->triangulation);
+            for (int i = 1; i <= edgeMap.Extent(); i++) {
+                auto& polygons = entry->edges[i - 1];
+                auto edge = TopoDS::Edge(edgeMap.FindKey(i));
+                if (polygons.seamPolygon.IsNull()) {
+                    builder.UpdateEdge(edge, polygons.polygon, entry->triangulation, location);
+                } else {
+                    builder.UpdateEdge(edge, polygons.polygon, polygons.seamPolygon, entry->triangulation, location);
+                }
+            }
+            restoredFaces()++;
+        }
+    }
+
+    /// @brief Stores the triangulation and edge polygons of every meshed face of the shape.
+    static void store(const TopoDS_Shape& shape, double deflection)
+    {
+        TopTools_IndexedMapOfShape faceMap;
+        TopExp::MapShapes(shape, TopAbs_FACE, faceMap);
+        for (TopTools_IndexedMapOfShape::Iterator anIt(faceMap); anIt.More(); anIt.Next()) {
+            auto face = TopoDS::Face(anIt.Value().Located(TopLoc_Location()));
+            TopLoc_Location location;
+            auto triangulation = BRep_Tool::Triangulation(face, location);
+            if (triangulation.IsNull()) {
+                continue;
+            }
+
+            Entry entry { deflection, triangulation, {} };
+            TopTools_IndexedMapOfShape edgeMap;
+            TopExp::MapShapes(face, TopAbs_EDGE, edgeMap);
+            entry.edges.reserve(edgeMap.Extent());
+            for (TopTools_IndexedMapOfShape::Iterator edgeIt(edgeMap); edgeIt.More(); edgeIt.Next()) {
+                auto edge = TopoDS::Edge(edgeIt.Value());
+                EdgePolygons polygons;
+                if (BRep_Tool::IsClosed(edge, triangulation, location)) {
+                    polygons.polygon = BRep_Tool::PolygonOnTriangulation(TopoDS::Edge(edge.Oriented(TopAbs_FORWARD)), triangulation, location);
+                    polygons.seamPolygon = BRep_Tool::PolygonOnTriangulation(TopoDS::Edge(edge.Oriented(TopAbs_REVERSED)), triangulation, location);
+                } else {
+                    polygons.polygon = BRep_Tool::PolygonOnTriangulation(edge, triangulation, location);
+                }
+                if (polygons.polygon.IsNull()) {
+                    break;
+                }
+                entry.edges.push_back(std::move(polygons));
+            }
+
+            if (entry.edges.size() == static_cast<size_t>(edgeMap.Extent())) {
+                entries().put(face.TShape(), std::move(entry));
+            }
+        }
+    }
+
+    static void clear()
+    {
+        entries().clear();
+    }
+
+    /// @brief Drops the faces whose TShape is only held by the caches, the key in its list and in its
+    /// lookup hold one reference each, ShapeCache the ones it reports. The ShapeCache entries of the
+    /// dropped faces are pruned right after. OccShape.dispose schedules it.
+    static void prune()
+    {
+        auto held = ShapeCache::heldTShapes();
+        entries().eraseIf([&held](const Handle(TopoDS_TShape) & tshape) {
+            auto it = held.find(tshape.get());
+            return tshape->GetRefCount() <= static_cast<int>(2 + (it == held.end() ? 0 : it->second));
+        });
+        ShapeCache::prune();
+    }
+
+    /// @brief Sets the number of triangles to keep, the least recently meshed faces are dropped first.
+    static void setCapacity(size_t capacity)
+    {
+        entries().setCapacity(capacity);
+    }
+
+    /// @brief The number of cached faces.
+    static size_t size()
+    {
+        return entries().size();
+    }
+
+    static size_t triangleCount()
+    {
+        return entries().totalWeight();
+    }
+
+    /// @brief The number of faces restore has given their triangles back since the start.
+    static size_t restoredCount()
+    {
+        return restoredFaces();
+    }
+};
+
+/// @brief Queues the edges of a shape, they use the polygon on the triangulation of their first face.
+/// Edges without one are sampled unless knownPoints holds them by their index in mapEF.
+void addShapeEdges(const TopTools_IndexedDataMapOfShapeListOfShape& mapEF, EdgeMesher& edgeMesher,
+    const std::unordered_map<TopoDS_Face, Handle_Poly_Triangulation>& facePolyMap,
+    const std::unordered_map<int, std::vector<gp_Pnt>>& knownPoints)
+{
+    for (int ie = 1; ie <= mapEF.Extent(); ie++) {
+        const TopoDS_Edge& aEdge = TopoDS::Edge(mapEF.FindKey(ie));
+
+        const TopTools_ListOfShape& aFaces = mapEF(ie);
+        if (aFaces.Extent() < 1) {
+            auto known = knownPoints.find(ie);
+            if (known != knownPoints.end()) {
+                edgeMesher.addEdge(aEdge, known->second);
+            } else {
+                edgeMesher.addEdge(aEdge, nullptr);
+            }
+        } else {
+            const TopoDS_Face& face = TopoDS::Face(aFaces.First());
+            auto it = facePolyMap.find(face);
+            if (it != facePolyMap.end()) {
+                edgeMesher.addEdge(aEdge, it->second);
+            } else {
+                edgeMesher.addEdge(aEdge, nullptr);
+            }
+        }
+    }
+}
+
+/// @brief Queues the faces of a shape and records their triangulations for addShapeEdges.
+void addShapeFaces(const TopTools_IndexedMapOfShape& faceMap, FaceMesher& faceMesher,
+    std::unordered_map<TopoDS_Face, Handle_Poly_Triangulation>& facePolyMap)
+{
+    for (TopTools_IndexedMapOfShape::Iterator anIt(faceMap); anIt.More(); anIt.Next()) {
+        auto face = TopoDS::Face(anIt.Value());
+        TopLoc_Location location;
+        auto handlePoly = BRep_Tool::Triangulation(face, location);
+        faceMesher.addFace(face, handlePoly, location.Transformation());
+        if (!handlePoly.IsNull()) {
+            facePolyMap[face] = handlePoly;
+        }
+    }
+}
+
+class Mesher {
+    TopoDS_Shape shape;
+    double lineDeflection;
+    MeshOptions options;
+    std::shared_ptr<EdgeMesher> edgeMesher;
+    std::shared_ptr<FaceMesher> faceMesher;
+
+public:
+    Mesher(const TopoDS_Shape& shape, double lineDeflection)
+        : Mesher(shape, lineDeflection, MeshOptions {})
+    {
+    }
+
+    Mesher(const TopoDS_Shape& shape, double lineDeflection, const MeshOptions& options)
+        : shape(shape)
+        , lineDeflection(boundingBoxRatio(shape, lineDeflection))
+        , options(options)
+    {
+    }
+
+    Float32Array edgesMeshPosition()
+    {
+        EdgeMesher mesher(this->lineDeflection);
+        TopTools_IndexedMapOfShape edgeMap;
+        TopExp::MapShapes(shape, TopAbs_EDGE, edgeMap);
+        mesher.reserve(edgeMap.Extent());
+        for (TopTools_IndexedMapOfShape::Iterator anIt(edgeMap); anIt.More(); anIt.Next()) {
+            mesher.addEdge(TopoDS::Edge(anIt.Value()), nullptr);
+        }
+        mesher.generateEdgeMeshes();
+
+        return typedArrayCopy<Float32Array>(mesher.position);
+    }
+
+    MeshData mesh()
+    {
+        TRACE_SCOPE("Mesher::mesh");
+        MeshCache::restore(shape, lineDeflection);
+        {
+            TRACE_SCOPE("BRepMesh_IncrementalMesh");
+            BRepMesh_IncrementalMesh mesh(shape, lineDeflection, true, ANGLE_DEFLECTION, true);
+        }
+        MeshCache::store(shape, lineDeflection);
+
+        TopTools_IndexedMapOfShape faceMap;
+        TopExp::MapShapes(shape, TopAbs_FACE, faceMap);
+        TopTools_IndexedDataMapOfShapeListOfShape mapEF;
+        TopExp::MapShapesAndAncestors(shape, TopAbs_EDGE, TopAbs_FACE, mapEF);
+
+        faceMesher = std::make_shared<FaceMesher>(options);
+        edgeMesher = std::make_shared<EdgeMesher>(lineDeflection, options.indexedEdges);
+        meshShape(faceMap, mapEF, *faceMesher, *edgeMesher, {});
+
+        return MeshData { EdgeMeshData { edgeMesher }, FaceMeshData { faceMesher } };
+    }
+
+    /// @brief Meshes every deflection tier in one call and returns them from coarse to fine. The deflections
+    /// are scaled like the constructor's one. The shape maps are built once, faces BRepMesh keeps between
+    /// tiers (planar ones usually) keep their triangles and edge polygons, and straight free edges are
+    /// discretized only once.
+    MeshDataArray meshLods(const NumberArray& deflections)
+    {
+        auto tiers = vecFromJSArray<double>(deflections);
+        std::sort(tiers.begin(), tiers.end(), std::greater<double>());
+
+        TopTools_IndexedMapOfShape faceMap;
+        TopExp::MapShapes(shape, TopAbs_FACE, faceMap);
+        TopTools_IndexedDataMapOfShapeListOfShape mapEF;
+        TopExp::MapShapesAndAncestors(shape, TopAbs_EDGE, TopAbs_FACE, mapEF);
+        auto straightEdges = straightFreeEdgePoints(mapEF);
+
+        double scale = boundingBoxRatio(shape, 1.0);
+        lods.clear();
+        lods.reserve(tiers.size());
+        val result = val::array();
+        for (size_t i = 0; i < tiers.size(); i++) {
+            double deflection = std::max(tiers[i] * scale, Precision::Confusion());
+            {
+                TRACE_SCOPE("BRepMesh_IncrementalMesh");
+                BRepMesh_IncrementalMesh mesh(shape, deflection, true, ANGLE_DEFLECTION, true);
+            }
+            if (i + 1 == tiers.size()) {
+                MeshCache::store(shape, deflection);
+            }
+
+            lods.emplace_back(deflection, options);
+            auto& lod = lods.back();
+            meshShape(faceMap, mapEF, *lod.faceMesher, *lod.edgeMesher, straightEdges);
+            result.call<void>("push", MeshData { EdgeMeshData { lod.edgeMesher }, FaceMeshData { lod.faceMesher } });
+        }
+
+        return MeshDataArray(result);
+    }
+
+    /// @brief Drops the Mesher's share of the buffers without waiting for it to be deleted, they are freed
+    /// once no MeshData refers to them either.
+    void release()
+    {
+        edgeMesher.reset();
+        faceMesher.reset();
+        lods.clear();
+    }
+
+    ~Mesher()
+    {
+        BRepTools::Clean(shape, true);
+    }
+
+private:
+    struct MeshLod {
+        std::shared_ptr<EdgeMesher> edgeMesher;
+        std::shared_ptr<FaceMesher> faceMesher;
+
+        MeshLod(double lineDeflection, const MeshOptions& options)
+            : edgeMesher(std::make_shared<EdgeMesher>(lineDeflection, options.indexedEdges))
+            , faceMesher(std::make_shared<FaceMesher>(options))
+        {
+        }
+    };
+
+    /// @brief The tiers of the last meshLods call.
+    std::vector<MeshLod> lods;
+
+    static void meshShape(const TopTools_IndexedMapOfShape& faceMap, const TopTools_IndexedDataMapOfShapeListOfShape& mapEF,
+        FaceMesher& faceMesher, EdgeMesher& edgeMesher, const std::unordered_map<int, std::vector<gp_Pnt>>& knownPoints)
+    {
+        std::unordered_map<TopoDS_Face, Handle(Poly_Triangulation)> facePolyMap;
+        facePolyMap.reserve(faceMap.Extent());
+        faceMesher.reserve(faceMap.Extent());
+        addShapeFaces(faceMap, faceMesher, facePolyMap);
+        faceMesher.generateFaceMeshes();
+
+        edgeMesher.reserve(mapEF.Extent());
+        addShapeEdges(mapEF, edgeMesher, facePolyMap, knownPoints);
+        edgeMesher.generateEdgeMeshes();
+    }
+
+    /// @brief Edges without a face are sampled from their curve, for lines the result does not depend on
+    /// the deflection.
+    static std::unordered_map<int, std::vector<gp_Pnt>> straightFreeEdgePoints(const TopTools_IndexedDataMapOfShapeListOfShape& mapEF)
+    {
+        std::unordered_map<int, std::vector<gp_Pnt>> result;
+        for (int ie = 1; ie <= mapEF.Extent(); ie++) {
+            if (mapEF(ie).Extent() > 0) {
+                continue;
+            }
+            const TopoDS_Edge& edge = TopoDS::Edge(mapEF.FindKey(ie));
+            if (BRepAdaptor_Curve(edge).GetType() == GeomAbs_Line) {
+                pointByGCTangential(edge, 1.0, result[ie]);
+            }
+        }
+        return result;
+    }
+};
+
+/// @brief Meshes many shapes in one call into a single set of buffers, so an assembly costs one call
+/// and one MeshData instead of one per part. Every shape keeps its own deflection.
+class BatchMesher {
+    std::vector<TopoDS_Shape> shapes;
+    double lineDeflection;
+    MeshOptions options;
+    std::shared_ptr<EdgeMesher> edgeMesher;
+    std::shared_ptr<FaceMesher> faceMesher;
+    /// @brief firstFace, faceCount, firstNode, nodeCount per shape
+    std::vector<uint32_t> faceRanges;
+    /// @brief firstEdge, edgeCount per shape
+    std::vector<uint32_t> edgeRanges;
+
+public:
+    BatchMesher(const ShapeArray& shapes, double lineDeflection)
+        : BatchMesher(shapes, lineDeflection, MeshOptions {})
+    {
+    }
+
+    BatchMesher(const ShapeArray& shapes, double lineDeflection, const MeshOptions& options)
+        : shapes(vecFromJSArray<TopoDS_Shape>(shapes))
+        , lineDeflection(lineDeflection)
+        , options(options)
+    {
+    }
+
+    MeshData mesh()
+    {
+        TRACE_SCOPE("BatchMesher::mesh");
+        int count = static_cast<int>(shapes.size());
+        std::vector<double> deflections(count);
+        std::vector<TopTools_IndexedMapOfShape> faceMaps(count);
+        std::vector<TopTools_IndexedDataMapOfShapeListOfShape> edgeMaps(count);
+        OSD_Parallel::For(0, count, [&](int i) { deflections[i] = boundingBoxRatio(shapes[i], lineDeflection); });
+
+        for (int i = 0; i < count; i++) {
+            MeshCache::restore(shapes[i], deflections[i]);
+        }
+        triangulate(deflections);
+        for (int i = 0; i < count; i++) {
+            MeshCache::store(shapes[i], deflections[i]);
+        }
+
+        OSD_Parallel::For(0, count, [&](int i) {
+            TopExp::MapShapes(shapes[i], TopAbs_FACE, faceMaps[i]);
+            TopExp::MapShapesAndAncestors(shapes[i], TopAbs_EDGE, TopAbs_FACE, edgeMaps[i]);
+        });
+
+        size_t faceCount = 0, edgeCount = 0;
+        for (int i = 0; i < count; i++) {
+            faceCount += faceMaps[i].Extent();
+            edgeCount += edgeMaps[i].Extent();
+        }
+
+        faceMesher = std::make_shared<FaceMesher>(options);
+        auto& faces = *faceMesher;
+        faces.reserve(faceCount);
+        faceRanges.resize(count * 4);
+        std::unordered_map<TopoDS_Face, Handle(Poly_Triangulation)> facePolyMap;
+        facePolyMap.reserve(faceCount);
+        for (int i = 0; i < count; i++) {
+            faceRanges[i * 4] = faces.faces.size();
+            faceRanges[i * 4 + 2] = faces.nodeSize();
+            addShapeFaces(faceMaps[i], faces, facePolyMap);
+            faceRanges[i * 4 + 1] = faces.faces.size() - faceRanges[i * 4];
+            faceRanges[i * 4 + 3] = faces.nodeSize() - faceRanges[i * 4 + 2];
+        }
+        faces.generateFaceMeshes();
+
+        edgeMesher = std::make_shared<EdgeMesher>(lineDeflection, options.indexedEdges);
+        auto& edges = *edgeMesher;
+        edges.reserve(edgeCount);
+        edgeRanges.resize(count * 2);
+        for (int i = 0; i < count; i++) {
+            edges.lineDeflection = deflections[i];
+            edgeRanges[i * 2] = edges.edges.size();
+            addShapeEdges(edgeMaps[i], edges, facePolyMap, {});
+            edgeRanges[i * 2 + 1] = edges.edges.size() - edgeRanges[i * 2];
+        }
+        edges.generateEdgeMeshes();
+
+        return MeshData { EdgeMeshData { edgeMesher }, FaceMeshData { faceMesher } };
+    }
+
+    Uint32Array shapeFaceRanges() const
+    {
+        return typedArrayView<Uint32Array>(faceRanges);
+    }
+
+    Uint32Array shapeEdgeRanges() const
+    {
+        return typedArrayView<Uint32Array>(edgeRanges);
+    }
+
+    void release()
+    {
+        edgeMesher.reset();
+        faceMesher.reset();
+        faceRanges = {};
+        edgeRanges = {};
+    }
+
+    ~BatchMesher()
+    {
+        for (auto& shape : shapes) {
+            BRepTools::Clean(shape, true);
+        }
+    }
+
+private:
+    /// @brief Shapes that share no face, edge, vertex, surface or curve with an earlier one are meshed
+    /// concurrently, BRepMesh running serially inside each. The others, such as further instances of a
+    /// part or copies that kept the geometry of their original, are meshed one after another afterwards
+    /// with BRepMesh running in parallel, and mostly find their faces already triangulated.
+    void triangulate(const std::vector<double>& deflections)
+    {
+        TRACE_SCOPE("BRepMesh_IncrementalMesh");
+        std::vector<int> concurrent, serial;
+        std::unordered_set<const Standard_Transient*> owned;
+        for (int i = 0; i < static_cast<int>(shapes.size()); i++) {
+            auto shared = sharedData(shapes[i]);
+            bool isShared = std::any_of(shared.begin(), shared.end(), [&owned](auto data) { return owned.count(data) > 0; });
+            (isShared ? serial : concurrent).push_back(i);
+            owned.insert(shared.begin(), shared.end());
+        }
+
+        OSD_Parallel::For(0, static_cast<int>(concurrent.size()), [&](int i) {
+            int index = concurrent[i];
+            BRepMesh_IncrementalMesh mesh(shapes[index], deflections[index], false, ANGLE_DEFLECTION, false);
+        });
+        for (int index : serial) {
+            BRepMesh_IncrementalMesh mesh(shapes[index], deflections[index], false, ANGLE_DEFLECTION, true);
+        }
+    }
+
+    /// @brief What meshing a shape writes to or reads from: the TShapes its triangulations and polygons are
+    /// stored on and the surfaces and curves they are computed from.
+    static std::unordered_set<const Standard_Transient*> sharedData(const TopoDS_Shape& shape)
+    {
+        std::unordered_set<const Standard_Transient*> shared;
+        TopLoc_Location location;
+        for (TopExp_Explorer explorer(shape, TopAbs_FACE); explorer.More(); explorer.Next()) {
+            const auto& face = TopoDS::Face(explorer.Current());
+            shared.insert(face.TShape().get());
+            shared.insert(BRep_Tool::Surface(face, location).get());
+        }
+        double first, last;
+        for (TopExp_Explorer explorer(shape, TopAbs_EDGE); explorer.More(); explorer.Next()) {
+            const auto& edge = TopoDS::Edge(explorer.Current());
+            shared.insert(edge.TShape().get());
+            shared.insert(BRep_Tool::Curve(edge, location, first, last).get());
+        }
+        for (TopExp_Explorer explorer(shape, TopAbs_VERTEX); explorer.More(); explorer.Next()) {
+            shared.insert(explorer.Current().TShape().get());
+        }
+        shared.erase(nullptr);
+        return shared;
+    }
+};
+
+/// @brief A versioned binary container of a shape and its mesh, reopening a model from it skips both the
+/// import and the tessellation. The layout, little endian:
+///   header: "CHMC", uint32 version, uint32 flags, uint32 section count, float64 line deflection
+///   section: char tag[4], uint32 byte length, the bytes padded to a multiple of 4
+/// BREP holds the BinTools shape with its triangulation, FPOS FNRM FUV_ FIDX FGRP and EPOS EIDX EGRP the
+/// buffers of FaceMeshData and EdgeMeshData. Readers skip unknown tags, so sections can be added without
+/// a new version, and the buffers stay 4 byte aligned to be viewed in place.
+class MeshContainer {
+    static constexpr uint32_t MAGIC = 0x434d4843; // "CHMC"
+    static constexpr uint32_t VERSION = 1;
+    static constexpr uint32_t FLAG_INDEXED_EDGES = 1;
+    static constexpr size_t HEADER_SIZE = 24;
+
+    TopoDS_Shape shape;
+    double lineDeflection = 0;
+    std::shared_ptr<EdgeMesher> edgeMesher = std::make_shared<EdgeMesher>(0);
+    std::shared_ptr<FaceMesher> faceMesher = std::make_shared<FaceMesher>();
+    bool valid = false;
+
+public:
+    /// @brief Meshes the shape the way Mesher::mesh does and packs the shape and the buffers.
+    static Uint8Array write(const TopoDS_Shape& shape, double lineDeflection)
+    {
+        Mesher mesher(shape, lineDeflection);
+        auto data = mesher.mesh();
+        auto faces = data.faceMeshData.mesher;
+        auto edges = data.edgeMeshData.mesher;
+
+        std::ostringstream brep(std::ios::binary);
+        BinTools::Write(shape, brep, true, false, BinTools_FormatVersion_CURRENT);
+        auto brepBytes = brep.str();
+
+        std::vector<uint8_t> out;
+        out.reserve(HEADER_SIZE + brepBytes.size() + faces->position.size() * 8 * sizeof(float)
+            + faces->index.size() * sizeof(uint32_t) + edges->position.size() * sizeof(float) + 1024);
+        writeValue(out, MAGIC);
+        writeValue(out, VERSION);
+        writeValue(out, edges->indexed ? FLAG_INDEXED_EDGES : 0u);
+        writeValue(out, uint32_t(9));
+        writeValue(out, edges->lineDeflection);
+
+        writeSection(out, "BREP", brepBytes.data(), brepBytes.size());
+        writeSection(out, "FPOS", faces->position);
+        writeSection(out, "FNRM", faces->normal);
+        writeSection(out, "FUV_", faces->uv);
+        writeSection(out, "FIDX", faces->index);
+        writeSection(out, "FGRP", faces->group);
+        writeSection(out, "EPOS", edges->position);
+        writeSection(out, "EIDX", edges->index);
+        writeSection(out, "EGRP", edges->group);
+
+        return typedArrayCopy<Uint8Array>(out);
+    }
+
+    /// @brief Unpacks a container, isValid is false when it is not one or was written by a newer version.
+    explicit MeshContainer(const Uint8Array& buffer)
+    {
+        std::vector<uint8_t> input = convertJSArrayToNumberVector<uint8_t>(buffer);
+        valid = read(input);
+        if (!valid) {
+            shape.Nullify();
+            faceMesher = std::make_shared<FaceMesher>();
+            edgeMesher = std::make_shared<EdgeMesher>(0);
+        }
+    }
+
+    bool isValid() const
+    {
+        return valid;
+    }
+
+    TopoDS_Shape getShape() const
+    {
+        return shape;
+    }
+
+    double getLineDeflection() const
+    {
+        return lineDeflection;
+    }
+
+    /// @brief Views over the stored buffers, the faces and edges are taken from the shape in the order
+    /// Mesher writes them.
+    MeshData meshData() const
+    {
+        return MeshData { EdgeMeshData { edgeMesher }, FaceMeshData { faceMesher } };
+    }
+
+    /// @brief Drops the container's share of the buffers, MeshData taken before keeps its own.
+    void release()
+    {
+        edgeMesher = std::make_shared<EdgeMesher>(lineDeflection, edgeMesher->indexed);
+        faceMesher = std::make_shared<FaceMesher>();
+    }
+
+private:
+    template <typename T>
+    static void writeValue(std::vector<uint8_t>& out, const T& value)
+    {
+        auto bytes = reinterpret_cast<const uint8_t*>(&value);
+        out.insert(out.end(), bytes, bytes + sizeof(T));
+    }
+
+    static void writeSection(std::vector<uint8_t>& out, const char* tag, const void* data, size_t size)
+    {
+        out.insert(out.end(), tag, tag + 4);
+        writeValue(out, static_cast<uint32_t>(size));
+        auto bytes = static_cast<const uint8_t*>(data);
+        out.insert(out.end(), bytes, bytes + size);
+        out.resize((out.size() + 3) & ~size_t(3), 0);
+    }
+
+    template <typename T>
+    static void writeSection(std::vector<uint8_t>& out, const char* tag, const std::vector<T>& data)
+    {
+        writeSection(out, tag, data.data(), data.size() * sizeof(T));
+    }
+
+    template <typename T>
+    static T readValue(const uint8_t* data)
+    {
+        T value;
+        std::memcpy(&value, data, sizeof(T));
+        return value;
+    }
+
+    template <typename T>
+    static bool readSection(const std::pair<const uint8_t*, size_t>& section, std::vector<T>& out)
+    {
+        if (section.second % sizeof(T) != 0) {
+            return false;
+        }
+        out.resize(section.second / sizeof(T));
+        std::memcpy(out.data(), section.first, section.second);
+        return true;
+    }
+
+    /// @brief Whether every group lies within a buffer of size elements.
+    static bool isGroupInRange(const std::vector<uint32_t>& group, size_t size)
+    {
+        if (group.size() % 2 != 0) {
+            return false;
+        }
+        for (size_t i = 0; i < group.size(); i += 2) {
+            if (uint64_t(group[i]) + group[i + 1] > size) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /// @brief Whether the buffers of a decoded container fit each other, so viewing them never reads
+    /// past a buffer. Normals and uvs may be left out, as MeshOptions allows.
+    static bool isInRange(const FaceMesher& faces)
+    {
+        size_t nodeCount = faces.position.size() / 3;
+        if (faces.position.size() % 3 != 0 || faces.index.size() % 3 != 0
+            || (!faces.normal.empty() && faces.normal.size() != faces.position.size())
+            || (!faces.uv.empty() && faces.uv.size() != nodeCount * 2)) {
+            return false;
+        }
+        bool isIndexInRange = std::all_of(faces.index.begin(), faces.index.end(), [nodeCount](uint32_t i) { return i < nodeCount; });
+        return isIndexInRange && isGroupInRange(faces.group, faces.index.size());
+    }
+
+    /// @brief Groups count indices when the edges are indexed, points otherwise.
+    static bool isInRange(const EdgeMesher& edges)
+    {
+        size_t pointCount = edges.position.size() / 3;
+        if (edges.position.size() % 3 != 0) {
+            return false;
+        }
+        if (!edges.indexed) {
+            return edges.index.empty() && isGroupInRange(edges.group, pointCount);
+        }
+        bool isIndexInRange = std::all_of(edges.index.begin(), edges.index.end(), [pointCount](uint32_t i) { return i < pointCount; });
+        return isIndexInRange && isGroupInRange(edges.group, edges.index.size());
+    }
+
+    bool read(const std::vector<uint8_t>& input)
+    {
+        if (input.size() < HEADER_SIZE || readValue<uint32_t>(input.data()) != MAGIC
+            || readValue<uint32_t>(input.data() + 4) > VERSION) {
+            return false;
+        }
+        uint32_t flags = readValue<uint32_t>(input.data() + 8);
+        uint32_t sectionCount = readValue<uint32_t>(input.data() + 12);
+        lineDeflection = readValue<double>(input.data() + 16);
+
+        std::unordered_map<std::string, std::pair<const uint8_t*, size_t>> sections;
+        size_t offset = HEADER_SIZE;
+        for (uint32_t i = 0; i < sectionCount; i++) {
+            if (input.size() - offset < 8) {
+                return false;
+            }
+            std::string tag(reinterpret_cast<const char*>(input.data() + offset), 4);
+            size_t size = readValue<uint32_t>(input.data() + offset + 4);
+            offset += 8;
+            if (input.size() - offset < size) {
+                return false;
+            }
+            sections[tag] = { input.data() + offset, size };
+            offset += (size + 3) & ~size_t(3);
+            offset = std::min(offset, input.size());
+        }
+
+        static const char* REQUIRED[] = { "BREP", "FPOS", "FNRM", "FUV_", "FIDX", "FGRP", "EPOS", "EIDX", "EGRP" };
+        for (auto tag : REQUIRED) {
+            if (sections.count(tag) == 0) {
+                return false;
+            }
+        }
+
+        auto& brep = sections["BREP"];
+        VectorBuffer brepBuffer(brep.first, brep.second);
+        std::istream brepStream(&brepBuffer);
+        try {
+            BinTools::Read(shape, brepStream);
+        } catch (const Standard_Failure&) {
+            // a truncated or corrupted BREP section
+            return false;
+        }
+        if (shape.IsNull()) {
+            return false;
+        }
+
+        edgeMesher = std::make_shared<EdgeMesher>(lineDeflection, (flags & FLAG_INDEXED_EDGES) != 0);
+        auto& faces = *faceMesher;
+        auto& edges = *edgeMesher;
+        bool isOk = readSection(sections["FPOS"], faces.position) && readSection(sections["FNRM"], faces.normal)
+            && readSection(sections["FUV_"], faces.uv) && readSection(sections["FIDX"], faces.index)
+            && readSection(sections["FGRP"], faces.group) && readSection(sections["EPOS"], edges.position)
+            && readSection(sections["EIDX"], edges.index) && readSection(sections["EGRP"], edges.group);
+        if (!isOk || !isInRange(faces) || !isInRange(edges)) {
+            return false;
+        }
+
+        TopTools_IndexedMapOfShape faceMap;
+        TopExp::MapShapes(shape, TopAbs_FACE, faceMap);
+        TopTools_IndexedDataMapOfShapeListOfShape mapEF;
+        TopExp::MapShapesAndAncestors(shape, TopAbs_EDGE, TopAbs_FACE, mapEF);
+        if (faces.group.size() != size_t(faceMap.Extent()) * 2 || edges.group.size() != size_t(mapEF.Extent()) * 2) {
+            return false;
+        }
+        for (TopTools_IndexedMapOfShape::Iterator anIt(faceMap); anIt.More(); anIt.Next()) {
+            faces.faces.push_back(TopoDS::Face(anIt.Value()));
+        }
+        for (int ie = 1; ie <= mapEF.Extent(); ie++) {
+            edges.edges.push_back(TopoDS::Edge(mapEF.FindKey(ie)));
+        }
+
+        // the stored triangulation lets later operations on the shape reuse it like a fresh mesh
+        MeshCache::store(shape, lineDeflection);
+        return true;
+    }
+};
+
+EMSCRIPTEN_BINDINGS(Mesher)
+{
+    class_<MeshCache>("MeshCache")
+        .class_function("clear", &MeshCache::clear)
+        .class_function("prune", &MeshCache::prune)
+        .class_function("setCapacity", &MeshCache::setCapacity)
+        .class_function("size", &MeshCache::size)
+        .class_function("triangleCount", &MeshCache::triangleCount)
+        .class_function("restoredCount", &MeshCache::restoredCount);
+
+    class_<EdgeDiscretizer>("EdgeDiscretizer")
+        .class_function("clear", &EdgeDiscretizer::clear)
+        .class_function("setCapacity", &EdgeDiscretizer::setCapacity)
+        .class_function("size", &EdgeDiscretizer::size);
+
+    value_object<MeshOptions>("MeshOptions")
+        .field("indexedEdges", &MeshOptions::indexedEdges)
+        .field("optimizeTriangleOrder", &MeshOptions::optimizeTriangleOrder)
+        .field("normals", &MeshOptions::normals)
+        .field("uvs", &MeshOptions::uvs);
+
+    class_<Mesher>("Mesher")
+        .constructor<TopoDS_Shape, double>()
+        .constructor<TopoDS_Shape, double, MeshOptions>()
+        .function("mesh", &Mesher::mesh)
+        .function("meshLods", &Mesher::meshLods)
+        .function("release", &Mesher::release)
+        .function("edgesMeshPosition", &Mesher::edgesMeshPosition);
+
+    class_<BatchMesher>("BatchMesher")
+        .constructor<const ShapeArray&, double>()
+        .constructor<const ShapeArray&, double, MeshOptions>()
+        .function("mesh", &BatchMesher::mesh)
+        .function("shapeFaceRanges", &BatchMesher::shapeFaceRanges)
+        .function("shapeEdgeRanges", &BatchMesher::shapeEdgeRanges)
+        .function("release", &BatchMesher::release);
+
+    class_<MeshContainer>("MeshContainer")
+        .constructor<const Uint8Array&>()
+        .class_function("write", &MeshContainer::write)
+        .function("isValid", &MeshContainer::isValid)
+        .function("shape", &MeshContainer::getShape)
+        .function("lineDeflection", &MeshContainer::getLineDeflection)
+        .function("meshData", &MeshContainer::meshData)
+        .function("release", &MeshContainer::release);
+
+    register_type<MeshDataArray>("Array<MeshData>");
+
+    class_<EdgeMeshData>("EdgeMeshData")
+        .property("position", &EdgeMeshData::position)
+        .property("index", &EdgeMeshData::index)
+        .property("group", &EdgeMeshData::group)
+        .property("edges", &EdgeMeshData::edges);
+
+    register_type<IndexArray>("Uint16Array | Uint32Array");
+
+    class_<QuantizedFaceMesh>("QuantizedFaceMesh")
+        .property("position", &QuantizedFaceMesh::getPosition)
+        .property("normal", &QuantizedFaceMesh::getNormal)
+        .property("uv", &QuantizedFaceMesh::getUv)
+        .property("index", &QuantizedFaceMesh::getIndex)
+        .property("group", &QuantizedFaceMesh::getGroup)
+        .property("positionBounds", &QuantizedFaceMesh::getPositionBounds)
+        .property("uvBounds", &QuantizedFaceMesh::getUvBounds);
+
+    class_<FaceMeshData>("FaceMeshData")
+        .property("position", &FaceMeshData::position)
+        .property("normal", &FaceMeshData::normal)
+        .property("uv", &FaceMeshData::uv)
+        .property("index", &FaceMeshData::index)
+        .property("group", &FaceMeshData::group)
+        .property("faces", &FaceMeshData::faces)
+        .function("quantize", &FaceMeshData::quantize);
+
+    class_<MeshData>("MeshData")
+        .property("edgeMeshData", &MeshData::edgeMeshData)
+        .property("faceMeshData", &MeshData::faceMeshData)
+        .function("buildBvh", &buildMeshBvh);
+
+    value_object<MeshBvhHit>("MeshBvhHit")
+        .field("index", &MeshBvhHit::index)
+        .field("distance", &MeshBvhHit::distance)
+        .field("point", &MeshBvhHit::point);
+    register_optional<MeshBvhHit>();
+
+    class_<MeshBvh>("MeshBvh")
+        .function("raycast", &raycastMeshBvh)
+        .function("nearestEdge", &nearestEdgeMeshBvh)
+        .function("triangleCount", &MeshBvh::triangleCount)
+        .function("segmentCount", &MeshBvh::segmentCount);
 }
@@ -0,0 +1,67 @@
+// Part of the Chili3d Project, under the AGPL-3.0 License.
+// See LICENSE file in the project root for full license information.
+
+#pragma once
+
+#include <emscripten/threading.h>
+#include <emscripten/val.h>
+
+#include <Message_ProgressIndicator.hxx>
+#include <Message_ProgressScope.hxx>
+
+#include <atomic>
+#include <string>
+
+/// @brief The error of a result whose operation was cancelled from its progress callback.
+inline constexpr const char* CANCELLED_ERROR = "Operation cancelled";
+
+/// @brief Forwards OCCT progress to a JS callback `(position: number, stage: string) => boolean | void`,
+/// returning false from the callback cancels the running operation.
+class JsProgressIndicator : public Message_ProgressIndicator {
+    emscripten::val callback;
+    bool hasCallback;
+    std::atomic<bool> cancelled { false };
+    double lastPosition = -1;
+
+public:
+    explicit JsProgressIndicator(const emscripten::val& callback)
+        : callback(callback)
+        , hasCallback(callback.typeOf().as<std::string>() == "function")
+    {
+    }
+
+    bool isCancelled() const
+    {
+        return cancelled;
+    }
+
+    Standard_Boolean UserBreak() override
+    {
+        return cancelled;
+    }
+
+    /// @brief OCCT may report from its worker threads, only the main thread can call into JS.
+    void Show(const Message_ProgressScope& scope, const Standard_Boolean isForce) override
+    {
+        if (!hasCallback || !emscripten_is_main_runtime_thread()) {
+            return;
+        }
+
+        double position = GetPosition();
+        if (!isForce && position - lastPosition < 0.01) {
+            return;
+        }
+        lastPosition = position;
+
+        std::string stage = scope.Name() == nullptr ? "" : scope.Name();
+        if (callback(position, stage).isFalse()) {
+            cancelled = true;
+        }
+    }
+
+    void Reset() override
+    {
+        Message_ProgressIndicator::Reset();
+        lastPosition = -1;
+    }
+};
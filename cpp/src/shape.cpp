@@ -13,8 +13,8 @@
 #include <BRepBuilderAPI_MakeFace.hxx>
 #include <BRepBuilderAPI_Sewing.hxx>
 #include <BRepExtrema_ExtCC.hxx>
-#include <BRepGProp.hxx>
 #include <BRepGProp_Face.hxx>
+#include <BRepMesh_IncrementalMesh.hxx>
 #include <BRepOffsetAPI_MakeOffset.hxx>
 #include <BRepPrim_Builder.hxx>
 #include <BRepTools.hxx>
@@ -30,6 +30,9 @@
 #include <HLRAlgo_Projector.hxx>
 #include <HLRBRep_Algo.hxx>
 #include <HLRBRep_HLRToShape.hxx>
+#include <HLRBRep_PolyAlgo.hxx>
+#include <HLRBRep_PolyHLRToShape.hxx>
+#include <OSD_Parallel.hxx>
 #include <ShapeAnalysis.hxx>
 #include <ShapeFix_Shape.hxx>
 #include <TopExp.hxx>
@@ -50,12 +53,46 @@
 #include <gp_Dir.hxx>
 #include <gp_Pnt.hxx>
 
+#include "progress.hpp"
 #include "shared.hpp"
 #include "utils.hpp"
 
 using namespace emscripten;
 
+/// @brief The projected edges of a hidden line removal by kind, so every line style of a drawing view
+/// comes from one run. Smooth edges are those between tangent faces, outlines the silhouettes of curved
+/// faces. Kinds without edges are null shapes.
+struct HlrResult {
+    TopoDS_Shape visible;
+    TopoDS_Shape visibleSmooth;
+    TopoDS_Shape visibleOutline;
+    TopoDS_Shape hidden;
+    TopoDS_Shape hiddenSmooth;
+    TopoDS_Shape hiddenOutline;
+};
+
 class Shape {
+    static HLRAlgo_Projector hlrProjector(const gp_Pnt& point, const gp_Dir& direction, const gp_Dir& xDirection)
+    {
+        gp_Ax3 ax3(point, direction, xDirection);
+        gp_Trsf trsf;
+        trsf.SetTransformation(ax3);
+        return HLRAlgo_Projector(trsf, false, false);
+    }
+
+    template <typename TToShape>
+    static HlrResult hlrResult(TToShape& toShape)
+    {
+        return HlrResult {
+            .visible = toShape.VCompound(),
+            .visibleSmooth = toShape.Rg1LineVCompound(),
+            .visibleOutline = toShape.OutLineVCompound(),
+            .hidden = toShape.HCompound(),
+            .hiddenSmooth = toShape.Rg1LineHCompound(),
+            .hiddenOutline = toShape.OutLineHCompound(),
+        };
+    }
+
 public:
     static TopoDS_Shape clone(const TopoDS_Shape& shape)
     {
@@ -71,20 +108,18 @@ public:
     static ShapeArray findAncestor(const TopoDS_Shape& from, const TopoDS_Shape& subShape,
         const TopAbs_ShapeEnum& ancestorType)
     {
-        TopTools_IndexedDataMapOfShapeListOfShape map;
-        TopExp::MapShapesAndAncestors(from, subShape.ShapeType(), ancestorType, map);
-        auto index = map.FindIndex(subShape);
-        auto shapes = map.FindFromIndex(index);
+        auto map = ShapeCache::ancestors(from, subShape.ShapeType(), ancestorType);
+        auto index = map->FindIndex(subShape);
+        const auto& shapes = map->FindFromIndex(index);
 
         return ShapeArray(val::array(shapes.begin(), shapes.end()));
     }
 
     static ShapeArray findSubShapes(const TopoDS_Shape& shape, const TopAbs_ShapeEnum& shapeType)
     {
-        TopTools_IndexedMapOfShape indexShape;
-        TopExp::MapShapes(shape, shapeType, indexShape);
+        auto indexShape = ShapeCache::subShapes(shape, shapeType);
 
-        return ShapeArray(val::array(indexShape.cbegin(), indexShape.cend()));
+        return ShapeArray(val::array(indexShape->cbegin(), indexShape->cend()));
     }
 
     static ShapeArray iterShape(const TopoDS_Shape& shape)
@@ -124,6 +159,12 @@ public:
     }
 
     static TopoDS_Shape removeFeature(const TopoDS_Shape& shape, const ShapeArray& faces)
+    {
+        return removeFeatureWithProgress(shape, faces, val::undefined());
+    }
+
+    /// @brief A null shape when the callback cancelled the defeaturing.
+    static TopoDS_Shape removeFeatureWithProgress(const TopoDS_Shape& shape, const ShapeArray& faces, const val& onProgress)
     {
         std::vector<TopoDS_Shape> facesVector = vecFromJSArray<TopoDS_Shape>(faces);
         BRepAlgoAPI_Defeaturing defea;
@@ -132,7 +173,11 @@ public:
             defea.AddFaceToRemove(face);
         }
         defea.SetRunParallel(true);
-        defea.Build();
+        Handle(JsProgressIndicator) progress = new JsProgressIndicator(onProgress);
+        defea.Build(progress->Start());
+        if (progress->isCancelled()) {
+            return TopoDS_Shape();
+        }
         return defea.Shape();
     }
 
@@ -220,21 +265,70 @@ public:
         return sewing.SewedShape();
     }
 
+    /// @brief Projects every edge as visible, it does not run HLRBRep_Algo::Hide the way hlrExact does.
     static TopoDS_Shape hlr(const TopoDS_Shape& shape, const gp_Pnt& point, const gp_Dir& direction, const gp_Dir& xDirection)
     {
-        gp_Ax3 ax3(point, direction, xDirection);
-        gp_Trsf trsf;
-        trsf.SetTransformation(ax3);
-
-        HLRAlgo_Projector projector(trsf, false, false);
         Handle_HLRBRep_Algo algo = new HLRBRep_Algo();
         algo->Add(shape);
-        algo->Projector(projector);
+        algo->Projector(hlrProjector(point, direction, xDirection));
         algo->Update();
 
         HLRBRep_HLRToShape hlrToShape(algo);
         return hlrToShape.VCompound();
     }
+
+    /// @brief Exact hidden line removal on the geometry, for final output. Unlike hlr it hides, so visible
+    /// only holds the edges that are not covered. HLRBRep_Algo takes no progress range, so neither hlr nor
+    /// hlrExact has a variant with a progress callback.
+    static HlrResult hlrExact(const TopoDS_Shape& shape, const gp_Pnt& point, const gp_Dir& direction, const gp_Dir& xDirection)
+    {
+        Handle(HLRBRep_Algo) algo = new HLRBRep_Algo();
+        algo->Add(shape);
+        algo->Projector(hlrProjector(point, direction, xDirection));
+        algo->Update();
+        algo->Hide();
+
+        HLRBRep_HLRToShape hlrToShape(algo);
+        return hlrResult(hlrToShape);
+    }
+
+    /// @brief Hidden line removal on the triangulation, much faster than hlrExact on large assemblies.
+    /// Faces without a triangulation as fine as deflection are meshed first, the edges are polylines
+    /// within about that distance of the exact ones. The meshing works on a copy of the topology that
+    /// shares the geometry and the existing triangulations, so the shape itself is left as it was.
+    static HlrResult hlrPolygonal(const TopoDS_Shape& shape, const gp_Pnt& point, const gp_Dir& direction,
+        const gp_Dir& xDirection, double deflection)
+    {
+        return hlrPolygonalWithProgress(shape, point, direction, xDirection, deflection, val::undefined());
+    }
+
+    /// @brief The callback follows the meshing, HLRBRep_PolyAlgo itself takes no progress range. Every
+    /// kind is a null shape when the callback cancelled the meshing.
+    static HlrResult hlrPolygonalWithProgress(const TopoDS_Shape& shape, const gp_Pnt& point, const gp_Dir& direction,
+        const gp_Dir& xDirection, double deflection, const val& onProgress)
+    {
+        BRepBuilderAPI_Copy copy(shape, false, true);
+        TopoDS_Shape meshed = copy.Shape();
+
+        Handle(JsProgressIndicator) progress = new JsProgressIndicator(onProgress);
+        IMeshTools_Parameters parameters;
+        parameters.Deflection = deflection;
+        parameters.Angle = ANGLE_DEFLECTION;
+        parameters.InParallel = true;
+        BRepMesh_IncrementalMesh mesh(meshed, parameters, progress->Start());
+        if (progress->isCancelled()) {
+            return HlrResult {};
+        }
+
+        Handle(HLRBRep_PolyAlgo) algo = new HLRBRep_PolyAlgo();
+        algo->Load(meshed);
+        algo->Projector(hlrProjector(point, direction, xDirection));
+        algo->Update();
+
+        HLRBRep_PolyHLRToShape hlrToShape;
+        hlrToShape.Update(algo);
+        return hlrResult(hlrToShape);
+    }
 };
 
 class Vertex {
@@ -256,9 +350,7 @@ public:
 
     static double curveLength(const TopoDS_Edge& edge)
     {
-        GProp_GProps props;
-        BRepGProp::LinearProperties(edge, props);
-        return props.Mass();
+        return ShapeCache::linearProperties(edge).Mass();
     }
 
     static Handle_Geom_TrimmedCurve curve(const TopoDS_Edge& edge)
@@ -306,6 +398,20 @@ public:
 
         return PointAndParameterArray(val::array(points));
     }
+
+    /// @brief The display polylines of many edges in one Float32Array, sampled like the mesher samples
+    /// edges and sharing its cache.
+    static PointSamples polylines(const EdgeArray& edges, double deflection)
+    {
+        auto edgeVec = vecFromJSArray<TopoDS_Edge>(edges);
+        std::vector<std::vector<gp_Pnt>> samples(edgeVec.size());
+        OSD_Parallel::For(0, static_cast<int>(edgeVec.size()), [&edgeVec, &samples, deflection](int i) {
+            if (!BRep_Tool::Degenerated(edgeVec[i])) {
+                EdgeDiscretizer::discretize(edgeVec[i], deflection, samples[i]);
+            }
+        });
+        return packSamples<Float32Array, float>(samples);
+    }
 };
 
 class Wire {
@@ -341,9 +447,7 @@ class Face {
 public:
     static double area(const TopoDS_Face& face)
     {
-        GProp_GProps props;
-        BRepGProp::SurfaceProperties(face, props);
-        return props.Mass();
+        return ShapeCache::surfaceProperties(face).Mass();
     }
 
     static TopoDS_Shape offset(const TopoDS_Face& face, double distance, const GeomAbs_JoinType& joinType)
@@ -397,14 +501,20 @@ class Solid {
 public:
     static double volume(const TopoDS_Solid& solid)
     {
-        GProp_GProps props;
-        BRepGProp::VolumeProperties(solid, props);
-        return props.Mass();
+        return ShapeCache::volumeProperties(solid).Mass();
     }
 };
 
 EMSCRIPTEN_BINDINGS(Shape)
 {
+    class_<HlrResult>("HlrResult")
+        .property("visible", &HlrResult::visible, return_value_policy::reference())
+        .property("visibleSmooth", &HlrResult::visibleSmooth, return_value_policy::reference())
+        .property("visibleOutline", &HlrResult::visibleOutline, return_value_policy::reference())
+        .property("hidden", &HlrResult::hidden, return_value_policy::reference())
+        .property("hiddenSmooth", &HlrResult::hiddenSmooth, return_value_policy::reference())
+        .property("hiddenOutline", &HlrResult::hiddenOutline, return_value_policy::reference());
+
     class_<Shape>("Shape")
         .class_function("clone", &Shape::clone)
         .class_function("findAncestor", &Shape::findAncestor)
@@ -415,11 +525,22 @@ EMSCRIPTEN_BINDINGS(Shape)
         .class_function("isClosed", &Shape::isClosed)
         .class_function("splitShapes", &Shape::splitShapes)
         .class_function("removeFeature", &Shape::removeFeature)
+        .class_function("removeFeature", &Shape::removeFeatureWithProgress)
         .class_function("removeSubShape", &Shape::removeSubShape)
         .class_function("replaceSubShape", &Shape::replaceSubShape)
         .class_function("hlr", &Shape::hlr)
+        .class_function("hlrExact", &Shape::hlrExact)
+        .class_function("hlrPolygonal", &Shape::hlrPolygonal)
+        .class_function("hlrPolygonal", &Shape::hlrPolygonalWithProgress)
         .class_function("sewing", &Shape::sewing);
 
+    class_<ShapeCache>("ShapeCache")
+        .class_function("invalidate", &ShapeCache::invalidate)
+        .class_function("prune", &ShapeCache::prune)
+        .class_function("clear", &ShapeCache::clear)
+        .class_function("setCapacity", &ShapeCache::setCapacity)
+        .class_function("size", &ShapeCache::size);
+
     class_<Vertex>("Vertex").class_function("point", &Vertex::point);
 
     class_<Edge>("Edge")
@@ -428,6 +549,7 @@ EMSCRIPTEN_BINDINGS(Shape)
         .class_function("curveLength", &Edge::curveLength)
         .class_function("trim", &Edge::trim)
         .class_function("intersect", &Edge::intersect)
+        .class_function("polylines", &Edge::polylines)
         .class_function("offset", &Edge::offset);
 
     class_<Wire>("Wire")
@@ -30,6 +30,8 @@ EMSCRIPTEN_BINDINGS(Shared)
     register_type<WireArray>("Array<TopoDS_Wire>");
     register_type<ShellArray>("Array<TopoDS_Shell>");
     register_type<PntArray>("Array<gp_Pnt>");
+    register_type<CurveArray>("Array<Geom_Curve>");
+    register_type<PointSamples>("PointSamples");
 
     register_optional<double>();
     register_optional<UV>();
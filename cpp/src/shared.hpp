@@ -209,3 +209,8 @@ EMSCRIPTEN_DECLARE_VAL_TYPE(ShellArray)
 EMSCRIPTEN_DECLARE_VAL_TYPE(ShapeArray)
 EMSCRIPTEN_DECLARE_VAL_TYPE(PointAndParameterArray)
 EMSCRIPTEN_DECLARE_VAL_TYPE(PntArray)
+EMSCRIPTEN_DECLARE_VAL_TYPE(CurveArray)
+
+/// @brief { points, offsets }, the sampled points of many curves in one typed array. The points of
+/// curve i are the x y z triples offsets[i] to offsets[i + 1].
+EMSCRIPTEN_DECLARE_VAL_TYPE(PointSamples)
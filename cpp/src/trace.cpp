@@ -0,0 +1,203 @@
+// Part of the Chili3d Project, under the AGPL-3.0 License.
+// See LICENSE file in the project root for full license information.
+
+#include "trace.hpp"
+
+#include <emscripten/bind.h>
+#include <emscripten/val.h>
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <vector>
+
+using namespace emscripten;
+
+namespace {
+
+/// @brief Bounds the memory of a trace that is never cleared, later stages still update the summary.
+constexpr size_t MAX_EVENTS = 1 << 18;
+
+struct TraceEvent {
+    const char* name;
+    double start;
+    double duration;
+    uint32_t thread;
+};
+
+struct StageSummary {
+    uint32_t calls = 0;
+    double total = 0;
+    double max = 0;
+};
+
+struct TraceData {
+    std::mutex mutex;
+    std::vector<TraceEvent> events;
+    std::map<std::string, StageSummary> stages;
+    std::map<std::string, double> counters;
+    size_t heapHighWater = 0;
+};
+
+TraceData& data()
+{
+    static TraceData instance;
+    return instance;
+}
+
+const auto START_TIME = std::chrono::steady_clock::now();
+
+/// @brief Small ids in the order threads first record, 0 is usually the main thread.
+uint32_t threadId()
+{
+    static std::atomic<uint32_t> next { 0 };
+    thread_local uint32_t id = next++;
+    return id;
+}
+
+/// @brief The top of the malloc heap, it only shrinks when dlmalloc trims, which makes it a cheap
+/// high-water mark compared to walking the heap with mallinfo.
+size_t heapTop()
+{
+    return reinterpret_cast<uintptr_t>(sbrk(0));
+}
+
+void appendJsonString(std::string& out, const std::string& value)
+{
+    out += '"';
+    for (char c : value) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+        }
+        out += c;
+    }
+    out += '"';
+}
+
+} // namespace
+
+bool Trace::enabled()
+{
+#ifdef CHILI_WASM_TRACE
+    return true;
+#else
+    return false;
+#endif
+}
+
+double Trace::now()
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - START_TIME).count();
+}
+
+void Trace::record(const char* name, double start, double duration)
+{
+    auto thread = threadId();
+    auto heap = heapTop();
+    auto& trace = data();
+    std::lock_guard<std::mutex> lock(trace.mutex);
+    if (trace.events.size() < MAX_EVENTS) {
+        trace.events.push_back(TraceEvent { name, start, duration, thread });
+    }
+    auto& stage = trace.stages[name];
+    stage.calls++;
+    stage.total += duration;
+    stage.max = std::max(stage.max, duration);
+    trace.heapHighWater = std::max(trace.heapHighWater, heap);
+}
+
+void Trace::count(const char* name, double value)
+{
+    auto& trace = data();
+    std::lock_guard<std::mutex> lock(trace.mutex);
+    trace.counters[name] += value;
+}
+
+void Trace::clear()
+{
+    auto& trace = data();
+    std::lock_guard<std::mutex> lock(trace.mutex);
+    trace.events.clear();
+    trace.stages.clear();
+    trace.counters.clear();
+    trace.heapHighWater = 0;
+}
+
+std::string Trace::chromeTrace()
+{
+    auto& trace = data();
+    std::lock_guard<std::mutex> lock(trace.mutex);
+
+    std::string out = "{\"traceEvents\":[";
+    char buffer[128];
+    double end = 0;
+    for (auto& event : trace.events) {
+        out += out.back() == '[' ? "{\"name\":" : ",{\"name\":";
+        appendJsonString(out, event.name);
+        // trace event timestamps are microseconds
+        std::snprintf(buffer, sizeof(buffer), ",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u}",
+            event.start * 1000, event.duration * 1000, event.thread);
+        out += buffer;
+        end = std::max(end, event.start + event.duration);
+    }
+
+    // the counters are totals, so each one is a single sample at the end of the trace
+    for (auto& [name, value] : trace.counters) {
+        out += out.back() == '[' ? "{\"name\":" : ",{\"name\":";
+        appendJsonString(out, name);
+        std::snprintf(buffer, sizeof(buffer), ",\"ph\":\"C\",\"ts\":%.3f,\"pid\":1,\"args\":{\"value\":%.17g}}",
+            end * 1000, value);
+        out += buffer;
+    }
+    out += "],\"otherData\":{\"heapHighWater\":";
+    out += std::to_string(trace.heapHighWater);
+    out += "}}";
+    return out;
+}
+
+/// @brief The JS side of Trace, stages() and counters() return plain objects keyed by name.
+class TraceQuery {
+public:
+    static val stages()
+    {
+        auto& trace = data();
+        std::lock_guard<std::mutex> lock(trace.mutex);
+        val result = val::object();
+        for (auto& [name, stage] : trace.stages) {
+            val summary = val::object();
+            summary.set("calls", stage.calls);
+            summary.set("total", stage.total);
+            summary.set("max", stage.max);
+            result.set(name, summary);
+        }
+        return result;
+    }
+
+    static val counters()
+    {
+        auto& trace = data();
+        std::lock_guard<std::mutex> lock(trace.mutex);
+        val result = val::object();
+        for (auto& [name, value] : trace.counters) {
+            result.set(name, value);
+        }
+        result.set("heapHighWater", static_cast<double>(trace.heapHighWater));
+        return result;
+    }
+};
+
+EMSCRIPTEN_BINDINGS(Trace)
+{
+    class_<Trace>("Trace")
+        .class_function("enabled", &Trace::enabled)
+        .class_function("clear", &Trace::clear)
+        .class_function("chromeTrace", &Trace::chromeTrace)
+        .class_function("stages", &TraceQuery::stages)
+        .class_function("counters", &TraceQuery::counters);
+}
@@ -0,0 +1,62 @@
+// Part of the Chili3d Project, under the AGPL-3.0 License.
+// See LICENSE file in the project root for full license information.
+
+#pragma once
+
+#include <string>
+
+/// @brief Timings and counters of the import, meshing and modelling hot paths. Only modules built with
+/// CHILI_WASM_TRACE record anything, otherwise TRACE_SCOPE and TRACE_COUNT compile to nothing and the
+/// JS side sees an empty trace.
+class Trace {
+public:
+    static bool enabled();
+
+    /// @brief Milliseconds since the module started.
+    static double now();
+
+    /// @brief Records a finished stage, safe to call from OSD_Parallel workers.
+    static void record(const char* name, double start, double duration);
+
+    /// @brief Adds value to the counter, counters are totals since the last clear.
+    static void count(const char* name, double value);
+
+    static void clear();
+
+    /// @brief The recorded stages as Chrome trace event JSON, for chrome://tracing or Perfetto.
+    static std::string chromeTrace();
+};
+
+#ifdef CHILI_WASM_TRACE
+
+class TraceScope {
+    const char* name;
+    double start;
+
+public:
+    explicit TraceScope(const char* name)
+        : name(name)
+        , start(Trace::now())
+    {
+    }
+
+    ~TraceScope()
+    {
+        Trace::record(name, start, Trace::now() - start);
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SCOPE(name) TraceScope TRACE_CONCAT(traceScope, __LINE__)(name)
+#define TRACE_COUNT(name, value) Trace::count(name, static_cast<double>(value))
+
+#else
+
+#define TRACE_SCOPE(name) ((void)0)
+#define TRACE_COUNT(name, value) ((void)0)
+
+#endif
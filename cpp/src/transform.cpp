@@ -0,0 +1,141 @@
+// Part of the Chili3d Project, under the AGPL-3.0 License.
+// See LICENSE file in the project root for full license information.
+
+#include "transform.hpp"
+
+#include <gp_Mat.hxx>
+
+#include <cmath>
+
+#ifdef __wasm_simd128__
+#include <wasm_simd128.h>
+#endif
+
+MeshTransform::MeshTransform(const gp_Trsf& trsf)
+{
+    // gp_Pnt::Transformed is scale * matrix * p + translation for every form of gp_Trsf
+    gp_Mat vectorial = trsf.VectorialPart();
+    gp_XYZ translation = trsf.TranslationPart();
+    for (int column = 0; column < 3; column++) {
+        for (int row = 0; row < 3; row++) {
+            pointMatrix[column][row] = vectorial.Value(row + 1, column + 1);
+        }
+        pointMatrix[column][3] = 0;
+    }
+    pointMatrix[3][0] = translation.X();
+    pointMatrix[3][1] = translation.Y();
+    pointMatrix[3][2] = translation.Z();
+    pointMatrix[3][3] = 0;
+
+    // gp_Dir::Transformed only rotates and reverses for a negative scale, mirrors included
+    gp_Mat rotation = trsf.HVectorialPart();
+    float sign = trsf.ScaleFactor() < 0 ? -1.0f : 1.0f;
+    for (int column = 0; column < 3; column++) {
+        for (int row = 0; row < 3; row++) {
+            normalMatrix[column][row] = sign * static_cast<float>(rotation.Value(row + 1, column + 1));
+        }
+        normalMatrix[column][3] = 0;
+    }
+}
+
+#ifdef __wasm_simd128__
+
+template <typename T>
+void MeshTransform::transformPoints(const T* in, size_t count, float* out) const
+{
+    // x y in one f64x2 and z in another, the fourth lane of each column is 0
+    v128_t c0xy = wasm_v128_load(&pointMatrix[0][0]), c0z = wasm_v128_load(&pointMatrix[0][2]);
+    v128_t c1xy = wasm_v128_load(&pointMatrix[1][0]), c1z = wasm_v128_load(&pointMatrix[1][2]);
+    v128_t c2xy = wasm_v128_load(&pointMatrix[2][0]), c2z = wasm_v128_load(&pointMatrix[2][2]);
+    v128_t txy = wasm_v128_load(&pointMatrix[3][0]), tz = wasm_v128_load(&pointMatrix[3][2]);
+    for (size_t i = 0; i < count; i++, in += 3, out += 3) {
+        v128_t x = wasm_f64x2_splat(in[0]);
+        v128_t y = wasm_f64x2_splat(in[1]);
+        v128_t z = wasm_f64x2_splat(in[2]);
+        v128_t xy = wasm_f64x2_add(wasm_f64x2_add(wasm_f64x2_mul(c0xy, x), wasm_f64x2_mul(c1xy, y)),
+            wasm_f64x2_add(wasm_f64x2_mul(c2xy, z), txy));
+        v128_t zw = wasm_f64x2_add(wasm_f64x2_add(wasm_f64x2_mul(c0z, x), wasm_f64x2_mul(c1z, y)),
+            wasm_f64x2_add(wasm_f64x2_mul(c2z, z), tz));
+        wasm_v128_store64_lane(out, wasm_f32x4_demote_f64x2_zero(xy), 0);
+        wasm_v128_store32_lane(out + 2, wasm_f32x4_demote_f64x2_zero(zw), 0);
+    }
+}
+
+void MeshTransform::normals(const float* in, size_t count, bool reverse, float* out) const
+{
+    v128_t sign = wasm_f32x4_splat(reverse ? -1.0f : 1.0f);
+    v128_t c0 = wasm_f32x4_mul(wasm_v128_load(normalMatrix[0]), sign);
+    v128_t c1 = wasm_f32x4_mul(wasm_v128_load(normalMatrix[1]), sign);
+    v128_t c2 = wasm_f32x4_mul(wasm_v128_load(normalMatrix[2]), sign);
+    for (size_t i = 0; i < count; i++, in += 3, out += 3) {
+        v128_t n = wasm_f32x4_add(wasm_f32x4_add(wasm_f32x4_mul(c0, wasm_f32x4_splat(in[0])),
+                                      wasm_f32x4_mul(c1, wasm_f32x4_splat(in[1]))),
+            wasm_f32x4_mul(c2, wasm_f32x4_splat(in[2])));
+        // the fourth lane is 0, so the horizontal sum of the squares is the squared length
+        v128_t squares = wasm_f32x4_mul(n, n);
+        squares = wasm_f32x4_add(squares, wasm_i32x4_shuffle(squares, squares, 1, 0, 3, 2));
+        squares = wasm_f32x4_add(squares, wasm_i32x4_shuffle(squares, squares, 2, 3, 0, 1));
+        v128_t length = wasm_f32x4_sqrt(squares);
+        if (wasm_f32x4_extract_lane(length, 0) > 0) {
+            n = wasm_f32x4_div(n, length);
+        }
+        wasm_v128_store64_lane(out, n, 0);
+        wasm_v128_store32_lane(out + 2, n, 2);
+    }
+}
+
+#else
+
+template <typename T>
+void MeshTransform::transformPoints(const T* in, size_t count, float* out) const
+{
+    const double(*m)[4] = pointMatrix;
+    for (size_t i = 0; i < count; i++, in += 3, out += 3) {
+        double x = in[0], y = in[1], z = in[2];
+        out[0] = static_cast<float>(m[0][0] * x + m[1][0] * y + m[2][0] * z + m[3][0]);
+        out[1] = static_cast<float>(m[0][1] * x + m[1][1] * y + m[2][1] * z + m[3][1]);
+        out[2] = static_cast<float>(m[0][2] * x + m[1][2] * y + m[2][2] * z + m[3][2]);
+    }
+}
+
+void MeshTransform::normals(const float* in, size_t count, bool reverse, float* out) const
+{
+    const float(*m)[4] = normalMatrix;
+    float sign = reverse ? -1.0f : 1.0f;
+    for (size_t i = 0; i < count; i++, in += 3, out += 3) {
+        float x = sign * in[0], y = sign * in[1], z = sign * in[2];
+        float nx = m[0][0] * x + m[1][0] * y + m[2][0] * z;
+        float ny = m[0][1] * x + m[1][1] * y + m[2][1] * z;
+        float nz = m[0][2] * x + m[1][2] * y + m[2][2] * z;
+        float length = std::sqrt(nx * nx + ny * ny + nz * nz);
+        if (length > 0) {
+            nx /= length;
+            ny /= length;
+            nz /= length;
+        }
+        out[0] = nx;
+        out[1] = ny;
+        out[2] = nz;
+    }
+}
+
+#endif
+
+void MeshTransform::points(const double* in, size_t count, float* out) const
+{
+    transformPoints(in, count, out);
+}
+
+void MeshTransform::points(const float* in, size_t count, float* out) const
+{
+    transformPoints(in, count, out);
+}
+
+gp_Pnt MeshTransform::point(const gp_Pnt& pnt) const
+{
+    const double(*m)[4] = pointMatrix;
+    double x = pnt.X(), y = pnt.Y(), z = pnt.Z();
+    return gp_Pnt(m[0][0] * x + m[1][0] * y + m[2][0] * z + m[3][0],
+        m[0][1] * x + m[1][1] * y + m[2][1] * z + m[3][1],
+        m[0][2] * x + m[1][2] * y + m[2][2] * z + m[3][2]);
+}
@@ -0,0 +1,39 @@
+// Part of the Chili3d Project, under the AGPL-3.0 License.
+// See LICENSE file in the project root for full license information.
+
+#pragma once
+
+#include <gp_Pnt.hxx>
+#include <gp_Trsf.hxx>
+
+#include <cstddef>
+
+/// @brief A gp_Trsf flattened for the node arrays of a mesh. It does what gp_Pnt::Transformed and
+/// gp_Dir::Transformed do per node without the switch over the transformation form, and writes floats
+/// in the same pass. Built with CHILI_WASM_SIMD the loops use wasm SIMD128, otherwise scalar code.
+class MeshTransform {
+public:
+    explicit MeshTransform(const gp_Trsf& trsf);
+
+    /// @brief Transforms count points of packed x y z, in keeps the double precision of the nodes.
+    void points(const double* in, size_t count, float* out) const;
+
+    /// @brief The same for the single precision nodes of a Poly_Triangulation.
+    void points(const float* in, size_t count, float* out) const;
+
+    /// @brief Rotates count packed normals and normalizes them, reverse flips them first like
+    /// gp_Dir::Reverse.
+    void normals(const float* in, size_t count, bool reverse, float* out) const;
+
+    gp_Pnt point(const gp_Pnt& pnt) const;
+
+private:
+    /// @brief The columns of the scaled rotation and the translation, x y z of each, so a column
+    /// loads as one vector.
+    alignas(16) double pointMatrix[4][4];
+    /// @brief The rotation of normals, the sign of a negative scale included.
+    alignas(16) float normalMatrix[3][4];
+
+    template <typename T>
+    void transformPoints(const T* in, size_t count, float* out) const;
+};
@@ -3,10 +3,20 @@
 
 #include "utils.hpp"
 
+#include <BRepAdaptor_Curve.hxx>
 #include <BRepBndLib.hxx>
+#include <BRepGProp.hxx>
 #include <Bnd_Box.hxx>
+#include <GCPnts_TangentialDeflection.hxx>
 #include <GeomAPI_ExtremaCurveCurve.hxx>
 #include <GeomAPI_ProjectPointOnCurve.hxx>
+#include <TopExp.hxx>
+#include <TopoDS.hxx>
+
+#include <map>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
 
 std::vector<ExtremaCCResult> extremaCCs(const Geom_Curve* curve1, const Geom_Curve* curve2, double maxDistance)
 {
@@ -77,8 +87,7 @@ ProjectPointResult projectOrNearestCP(const Geom_Curve* curve, const gp_Pnt& pnt
 
 double boundingBoxRatio(const TopoDS_Shape& shape, double linearDeflection)
 {
-    Bnd_Box boundingBox;
-    BRepBndLib::Add(shape, boundingBox, false);
+    Bnd_Box boundingBox = ShapeCache::bounds(shape);
     if (boundingBox.IsVoid()) {
         return linearDeflection;
     }
@@ -93,6 +102,307 @@ double boundingBoxRatio(const TopoDS_Shape& shape, double linearDeflection)
     return linDeflection;
 }
 
+namespace {
+
+struct EdgeSamplesKey {
+    Handle(TopoDS_TShape) tshape;
+    double deflection;
+
+    bool operator==(const EdgeSamplesKey& other) const
+    {
+        return tshape == other.tshape && deflection == other.deflection;
+    }
+};
+
+struct EdgeSamplesKeyHash {
+    size_t operator()(const EdgeSamplesKey& key) const
+    {
+        return std::hash<Handle(TopoDS_TShape)>()(key.tshape) ^ (std::hash<double>()(key.deflection) << 1);
+    }
+};
+
+constexpr size_t EDGE_SAMPLES_CAPACITY = 20000;
+
+std::mutex edgeSamplesMutex;
+
+LruCache<EdgeSamplesKey, std::vector<gp_Pnt>, EdgeSamplesKeyHash>& edgeSamples()
+{
+    static LruCache<EdgeSamplesKey, std::vector<gp_Pnt>, EdgeSamplesKeyHash> cache(EDGE_SAMPLES_CAPACITY);
+    return cache;
+}
+
+} // namespace
+
+void EdgeDiscretizer::discretize(const TopoDS_Edge& edge, double deflection, std::vector<gp_Pnt>& points)
+{
+    EdgeSamplesKey key { edge.TShape(), deflection };
+    bool isCached = false;
+    {
+        std::lock_guard<std::mutex> lock(edgeSamplesMutex);
+        if (auto cached = edgeSamples().find(key)) {
+            points = *cached;
+            isCached = true;
+        }
+    }
+
+    if (!isCached) {
+        BRepAdaptor_Curve curve(TopoDS::Edge(edge.Located(TopLoc_Location())));
+        GCPnts_TangentialDeflection pnts(curve, ANGLE_DEFLECTION, deflection);
+        points.resize(pnts.NbPoints());
+        for (int i = 0; i < pnts.NbPoints(); i++) {
+            points[i] = pnts.Value(i + 1);
+        }
+
+        std::lock_guard<std::mutex> lock(edgeSamplesMutex);
+        edgeSamples().put(key, points);
+    }
+
+    if (!edge.Location().IsIdentity()) {
+        const gp_Trsf& trsf = edge.Location().Transformation();
+        for (auto& point : points) {
+            point.Transform(trsf);
+        }
+    }
+}
+
+void EdgeDiscretizer::clear()
+{
+    std::lock_guard<std::mutex> lock(edgeSamplesMutex);
+    edgeSamples().clear();
+}
+
+void EdgeDiscretizer::setCapacity(size_t capacity)
+{
+    std::lock_guard<std::mutex> lock(edgeSamplesMutex);
+    edgeSamples().setCapacity(capacity);
+}
+
+size_t EdgeDiscretizer::size()
+{
+    std::lock_guard<std::mutex> lock(edgeSamplesMutex);
+    return edgeSamples().size();
+}
+
+namespace {
+
+struct ShapeProperties {
+    std::optional<Bnd_Box> bounds;
+    std::optional<GProp_GProps> linear;
+    std::optional<GProp_GProps> surface;
+    std::optional<GProp_GProps> volume;
+    std::map<TopAbs_ShapeEnum, std::shared_ptr<const TopTools_IndexedMapOfShape>> subShapes;
+    std::map<std::pair<TopAbs_ShapeEnum, TopAbs_ShapeEnum>,
+        std::shared_ptr<const TopTools_IndexedDataMapOfShapeListOfShape>>
+        ancestors;
+};
+
+constexpr size_t SHAPE_PROPERTIES_CAPACITY = 2000;
+
+std::mutex shapePropertiesMutex;
+
+LruCache<TopoDS_Shape, ShapeProperties>& shapeProperties()
+{
+    static LruCache<TopoDS_Shape, ShapeProperties> cache(SHAPE_PROPERTIES_CAPACITY);
+    return cache;
+}
+
+/// @brief The handles the entry of key holds on the TShape of key: none for the key, which the caller
+/// counts, but one for every time the cached maps contain the shape itself.
+size_t selfReferences(const TopoDS_Shape& key, const ShapeProperties& entry)
+{
+    auto type = key.ShapeType();
+    auto isKey = [&key](const TopoDS_Shape& shape) { return shape.TShape() == key.TShape(); };
+    size_t count = 0;
+    if (auto it = entry.subShapes.find(type); it != entry.subShapes.end() && it->second) {
+        for (TopTools_IndexedMapOfShape::Iterator shape(*it->second); shape.More(); shape.Next()) {
+            count += isKey(shape.Value());
+        }
+    }
+    for (const auto& [types, map] : entry.ancestors) {
+        if (!map || (types.first != type && types.second != type)) {
+            continue;
+        }
+        for (int i = 1; i <= map->Extent(); i++) {
+            count += types.first == type && isKey(map->FindKey(i));
+            if (types.second == type) {
+                for (const auto& ancestor : map->FindFromIndex(i)) {
+                    count += isKey(ancestor);
+                }
+            }
+        }
+    }
+    return count;
+}
+
+template <typename T>
+const T& cachedValue(const std::optional<T>& value)
+{
+    return *value;
+}
+
+template <typename T>
+const std::shared_ptr<T>& cachedValue(const std::shared_ptr<T>& value)
+{
+    return value;
+}
+
+/// @brief The cached value of field, otherwise computes it without holding the lock. Values are copied
+/// out, the maps through shared_ptr, so an eviction by another thread cannot invalidate them.
+template <typename TField, typename TCompute>
+auto cachedProperty(const TopoDS_Shape& shape, TField field, TCompute&& compute) -> decltype(compute())
+{
+    {
+        std::lock_guard<std::mutex> lock(shapePropertiesMutex);
+        if (auto entry = shapeProperties().find(shape)) {
+            if (auto& value = field(*entry)) {
+                return cachedValue(value);
+            }
+        }
+    }
+
+    auto value = compute();
+    std::lock_guard<std::mutex> lock(shapePropertiesMutex);
+    auto entry = shapeProperties().find(shape);
+    if (entry == nullptr) {
+        shapeProperties().put(shape, ShapeProperties());
+        entry = shapeProperties().find(shape);
+    }
+    // a capacity of 0 keeps nothing
+    if (entry != nullptr) {
+        field(*entry) = value;
+    }
+    return value;
+}
+
+} // namespace
+
+Bnd_Box ShapeCache::bounds(const TopoDS_Shape& shape)
+{
+    return cachedProperty(
+        shape, [](ShapeProperties& entry) -> auto& { return entry.bounds; },
+        [&shape] {
+            Bnd_Box box;
+            BRepBndLib::Add(shape, box, false);
+            return box;
+        });
+}
+
+GProp_GProps ShapeCache::linearProperties(const TopoDS_Shape& shape)
+{
+    return cachedProperty(
+        shape, [](ShapeProperties& entry) -> auto& { return entry.linear; },
+        [&shape] {
+            GProp_GProps props;
+            BRepGProp::LinearProperties(shape, props);
+            return props;
+        });
+}
+
+GProp_GProps ShapeCache::surfaceProperties(const TopoDS_Shape& shape)
+{
+    return cachedProperty(
+        shape, [](ShapeProperties& entry) -> auto& { return entry.surface; },
+        [&shape] {
+            GProp_GProps props;
+            BRepGProp::SurfaceProperties(shape, props);
+            return props;
+        });
+}
+
+GProp_GProps ShapeCache::volumeProperties(const TopoDS_Shape& shape)
+{
+    return cachedProperty(
+        shape, [](ShapeProperties& entry) -> auto& { return entry.volume; },
+        [&shape] {
+            GProp_GProps props;
+            BRepGProp::VolumeProperties(shape, props);
+            return props;
+        });
+}
+
+std::shared_ptr<const TopTools_IndexedMapOfShape> ShapeCache::subShapes(const TopoDS_Shape& shape, TopAbs_ShapeEnum type)
+{
+    return cachedProperty(
+        shape, [type](ShapeProperties& entry) -> auto& { return entry.subShapes[type]; },
+        [&shape, type] {
+            auto map = std::make_shared<TopTools_IndexedMapOfShape>();
+            TopExp::MapShapes(shape, type, *map);
+            return std::shared_ptr<const TopTools_IndexedMapOfShape>(map);
+        });
+}
+
+std::shared_ptr<const TopTools_IndexedDataMapOfShapeListOfShape> ShapeCache::ancestors(
+    const TopoDS_Shape& shape, TopAbs_ShapeEnum type, TopAbs_ShapeEnum ancestorType)
+{
+    return cachedProperty(
+        shape, [type, ancestorType](ShapeProperties& entry) -> auto& { return entry.ancestors[{ type, ancestorType }]; },
+        [&shape, type, ancestorType] {
+            auto map = std::make_shared<TopTools_IndexedDataMapOfShapeListOfShape>();
+            TopExp::MapShapesAndAncestors(shape, type, ancestorType, *map);
+            return std::shared_ptr<const TopTools_IndexedDataMapOfShapeListOfShape>(map);
+        });
+}
+
+void ShapeCache::invalidate(const TopoDS_Shape& shape)
+{
+    std::lock_guard<std::mutex> lock(shapePropertiesMutex);
+    shapeProperties().eraseIf([&shape](const TopoDS_Shape& key) { return key.IsSame(shape); });
+}
+
+namespace {
+
+/// @brief The key of every entry is held twice, by its list node and by the lookup.
+std::unordered_map<const TopoDS_TShape*, size_t> heldReferences()
+{
+    std::unordered_map<const TopoDS_TShape*, size_t> held;
+    shapeProperties().forEach([&held](const TopoDS_Shape& key, const ShapeProperties& entry) {
+        if (!key.IsNull()) {
+            held[key.TShape().get()] += 2 + selfReferences(key, entry);
+        }
+    });
+    return held;
+}
+
+} // namespace
+
+std::unordered_map<const TopoDS_TShape*, size_t> ShapeCache::heldTShapes()
+{
+    std::lock_guard<std::mutex> lock(shapePropertiesMutex);
+    return heldReferences();
+}
+
+void ShapeCache::prune()
+{
+    std::lock_guard<std::mutex> lock(shapePropertiesMutex);
+    // the maps of a compound hold its children, so dropping it can release them for the next pass
+    size_t size;
+    do {
+        size = shapeProperties().size();
+        auto held = heldReferences();
+        shapeProperties().eraseIf([&held](const TopoDS_Shape& key) {
+            return key.IsNull() || key.TShape()->GetRefCount() <= static_cast<int>(held[key.TShape().get()]);
+        });
+    } while (shapeProperties().size() != size);
+}
+
+void ShapeCache::clear()
+{
+    std::lock_guard<std::mutex> lock(shapePropertiesMutex);
+    shapeProperties().clear();
+}
+
+void ShapeCache::setCapacity(size_t capacity)
+{
+    std::lock_guard<std::mutex> lock(shapePropertiesMutex);
+    shapeProperties().setCapacity(capacity);
+}
+
+size_t ShapeCache::size()
+{
+    std::lock_guard<std::mutex> lock(shapePropertiesMutex);
+    return shapeProperties().size();
+}
+
 TopTools_SequenceOfShape shapeArrayToSequenceOfShape(const ShapeArray& shapes)
 {
     std::vector<TopoDS_Shape> shapeVector = emscripten::vecFromJSArray<TopoDS_Shape>(shapes);
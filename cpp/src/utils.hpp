@@ -3,13 +3,26 @@
 
 #pragma once
 
+#include <Bnd_Box.hxx>
+#include <GProp_GProps.hxx>
 #include <Geom_Curve.hxx>
+#include <TopoDS_Edge.hxx>
+#include <TopTools_IndexedDataMapOfShapeListOfShape.hxx>
+#include <TopTools_IndexedMapOfShape.hxx>
 #include <TopTools_ListOfShape.hxx>
 #include <TopTools_SequenceOfShape.hxx>
 #include <TopoDS_Shape.hxx>
 #include <gp_Pnt.hxx>
 
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <streambuf>
+#include <unordered_map>
+#include <vector>
+
 #include "shared.hpp"
+#include "trace.hpp"
 
 std::vector<ExtremaCCResult> extremaCCs(const Geom_Curve* curve1, const Geom_Curve* curve2, double maxDistance);
 
@@ -22,4 +35,254 @@ ProjectPointResult projectOrNearestCP(const Geom_Curve* curve, const gp_Pnt& pnt
 TopTools_SequenceOfShape shapeArrayToSequenceOfShape(const ShapeArray& shapes);
 TopTools_ListOfShape shapeArrayToListOfShape(const ShapeArray& shapes);
 
-double boundingBoxRatio(const TopoDS_Shape& shape, double linearDeflection);
\ No newline at end of file
+double boundingBoxRatio(const TopoDS_Shape& shape, double linearDeflection);
+
+const double ANGLE_DEFLECTION = 0.2;
+
+/// @brief Samples edges with GCPnts_TangentialDeflection and keeps the points of the most recently sampled
+/// ones by TShape and deflection, in the frame of the TShape. The mesher and the exporters share it, so
+/// unchanged curves are not sampled again. It can be called from OSD_Parallel loops.
+class EdgeDiscretizer {
+public:
+    static void discretize(const TopoDS_Edge& edge, double deflection, std::vector<gp_Pnt>& points);
+
+    static void clear();
+
+    /// @brief Sets the number of edges to keep, the least recently sampled ones are dropped first.
+    static void setCapacity(size_t capacity);
+
+    static size_t size();
+};
+
+/// @brief Memoizes the bounds, mass properties and sub-shape maps of the most recently queried shapes,
+/// keyed by TShape, location and orientation. It treats shapes as immutable, but nothing enforces that:
+/// editing a curve or surface an edge or face shares, or a TShape through BRep_Builder, leaves stale
+/// entries, call invalidate then. Triangulations are not read, so meshing does not. A key holds its
+/// shape, prune drops the shapes nothing else holds. It can be called from OSD_Parallel loops.
+class ShapeCache {
+public:
+    /// @brief BRepBndLib::Add without triangulations.
+    static Bnd_Box bounds(const TopoDS_Shape& shape);
+
+    static GProp_GProps linearProperties(const TopoDS_Shape& shape);
+
+    static GProp_GProps surfaceProperties(const TopoDS_Shape& shape);
+
+    static GProp_GProps volumeProperties(const TopoDS_Shape& shape);
+
+    /// @brief TopExp::MapShapes, the indices are the ones JS uses for sub-shapes.
+    static std::shared_ptr<const TopTools_IndexedMapOfShape> subShapes(const TopoDS_Shape& shape, TopAbs_ShapeEnum type);
+
+    /// @brief TopExp::MapShapesAndAncestors.
+    static std::shared_ptr<const TopTools_IndexedDataMapOfShapeListOfShape> ancestors(
+        const TopoDS_Shape& shape, TopAbs_ShapeEnum type, TopAbs_ShapeEnum ancestorType);
+
+    /// @brief Drops the entries of the shape, whatever its location and orientation.
+    static void invalidate(const TopoDS_Shape& shape);
+
+    /// @brief Drops the entries of the shapes only the cache still holds. OccShape.dispose schedules it.
+    static void prune();
+
+    /// @brief The number of handles the entries hold on the TShape of each key, for caches that prune
+    /// what only the caches hold.
+    static std::unordered_map<const TopoDS_TShape*, size_t> heldTShapes();
+
+    static void clear();
+
+    /// @brief Sets the number of shapes to keep, the least recently queried ones are dropped first.
+    static void setCapacity(size_t capacity);
+
+    static size_t size();
+};
+
+template <typename TArray, typename T>
+TArray typedArrayView(const std::vector<T>& data)
+{
+    return TArray(emscripten::val(emscripten::typed_memory_view(data.size(), data.data())));
+}
+
+template <typename TArray, typename T>
+TArray typedArrayCopy(const std::vector<T>& data)
+{
+    TRACE_SCOPE("typedArrayCopy");
+    TRACE_COUNT("copiedBytes", data.size() * sizeof(T));
+    return TArray(typedArrayView<TArray>(data).template call<emscripten::val>("slice"));
+}
+
+/// @brief Packs the point lists into a PointSamples, T is the element type of TArray.
+template <typename TArray, typename T>
+PointSamples packSamples(const std::vector<std::vector<gp_Pnt>>& samples)
+{
+    std::vector<uint32_t> offsets(samples.size() + 1, 0);
+    for (size_t i = 0; i < samples.size(); i++) {
+        offsets[i + 1] = offsets[i] + static_cast<uint32_t>(samples[i].size());
+    }
+
+    std::vector<T> points;
+    points.reserve(offsets.back() * 3);
+    for (auto& sample : samples) {
+        for (auto& point : sample) {
+            points.push_back(static_cast<T>(point.X()));
+            points.push_back(static_cast<T>(point.Y()));
+            points.push_back(static_cast<T>(point.Z()));
+        }
+    }
+
+    emscripten::val result = emscripten::val::object();
+    result.set("points", typedArrayCopy<TArray>(points));
+    result.set("offsets", typedArrayCopy<Uint32Array>(offsets));
+    return PointSamples(result);
+}
+
+/// @brief Counts every entry as one, so the capacity of an LruCache is a number of entries.
+struct UnitWeight {
+    template <typename TValue>
+    size_t operator()(const TValue&) const
+    {
+        return 1;
+    }
+};
+
+/// @brief A bounded map that evicts the least recently used entries once their total weight exceeds the
+/// capacity. The weight of a value is taken when it is put, values edited through find keep it.
+template <typename TKey, typename TValue, typename THash = std::hash<TKey>, typename TWeight = UnitWeight>
+class LruCache {
+    using Entry = std::pair<TKey, TValue>;
+
+    size_t capacity;
+    size_t weight = 0;
+    std::list<Entry> entries;
+    std::unordered_map<TKey, typename std::list<Entry>::iterator, THash> lookup;
+    TWeight weigher;
+
+public:
+    explicit LruCache(size_t capacity)
+        : capacity(capacity)
+    {
+    }
+
+    /// @brief Returns the cached value and marks it as the most recently used, or nullptr.
+    TValue* find(const TKey& key)
+    {
+        auto it = lookup.find(key);
+        if (it == lookup.end()) {
+            return nullptr;
+        }
+        entries.splice(entries.begin(), entries, it->second);
+        return &it->second->second;
+    }
+
+    void put(const TKey& key, TValue value)
+    {
+        auto it = lookup.find(key);
+        if (it != lookup.end()) {
+            weight -= weigher(it->second->second);
+            it->second->second = std::move(value);
+            weight += weigher(it->second->second);
+            entries.splice(entries.begin(), entries, it->second);
+        } else {
+            entries.emplace_front(key, std::move(value));
+            lookup.emplace(key, entries.begin());
+            weight += weigher(entries.front().second);
+        }
+        trim();
+    }
+
+    void erase(const TKey& key)
+    {
+        auto it = lookup.find(key);
+        if (it != lookup.end()) {
+            weight -= weigher(it->second->second);
+            entries.erase(it->second);
+            lookup.erase(it);
+        }
+    }
+
+    template <typename TPredicate>
+    void eraseIf(TPredicate&& predicate)
+    {
+        for (auto it = entries.begin(); it != entries.end();) {
+            if (predicate(it->first)) {
+                weight -= weigher(it->second);
+                lookup.erase(it->first);
+                it = entries.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    /// @brief Visits every entry from the most to the least recently used, without marking them used.
+    template <typename TFunction>
+    void forEach(TFunction&& function) const
+    {
+        for (const auto& [key, value] : entries) {
+            function(key, value);
+        }
+    }
+
+    void clear()
+    {
+        entries.clear();
+        lookup.clear();
+        weight = 0;
+    }
+
+    void setCapacity(size_t value)
+    {
+        capacity = value;
+        trim();
+    }
+
+    size_t size() const
+    {
+        return entries.size();
+    }
+
+    size_t totalWeight() const
+    {
+        return weight;
+    }
+
+private:
+    void trim()
+    {
+        while (weight > capacity && !entries.empty()) {
+            weight -= weigher(entries.back().second);
+            lookup.erase(entries.back().first);
+            entries.pop_back();
+        }
+    }
+};
+
+/// @brief A read only stream buffer over bytes that stay owned by the caller.
+class VectorBuffer : public std::streambuf {
+public:
+    VectorBuffer(const std::vector<uint8_t>& v)
+        : VectorBuffer(v.data(), v.size())
+    {
+    }
+
+    VectorBuffer(const uint8_t* data, size_t size)
+    {
+        setg((char*)data, (char*)data, (char*)(data + size));
+    }
+
+protected:
+    /// @brief Readers such as RWStl_Reader probe the format and the size with seekg/tellg.
+    pos_type seekoff(off_type offset, std::ios_base::seekdir dir, std::ios_base::openmode) override
+    {
+        char* base = dir == std::ios_base::beg ? eback() : dir == std::ios_base::cur ? gptr() : egptr();
+        char* target = base + offset;
+        if (target < eback() || target > egptr()) {
+            return pos_type(off_type(-1));
+        }
+        setg(eback(), target, egptr());
+        return pos_type(target - eback());
+    }
+
+    pos_type seekpos(pos_type position, std::ios_base::openmode mode) override
+    {
+        return seekoff(off_type(position), std::ios_base::beg, mode);
+    }
+};
@@ -82,7 +82,7 @@ export class DefaultDataExchange implements IDataExchange {
 
     private async importStep(document: IDocument, file: File) {
         const content = new Uint8Array(await file.arrayBuffer());
-        return document.application.shapeFactory.converter.convertFromSTEP(document, content);
+        return document.application.shapeFactory.converter.convertFromSTEPAsync(document, content);
     }
 
     async export(type: string, nodes: VisualNode[]): Promise<BlobPart[] | undefined> {
@@ -15,6 +15,19 @@ export enum Orientation {
     EXTERNAL,
 }
 
+/**
+ * The projected edges of a hidden line removal by kind, undefined when there are none of that kind.
+ * Smooth edges lie between tangent faces, outlines are the silhouettes of curved faces.
+ */
+export interface HlrLines {
+    visible?: IShape;
+    visibleSmooth?: IShape;
+    visibleOutline?: IShape;
+    hidden?: IShape;
+    hiddenSmooth?: IShape;
+    hiddenOutline?: IShape;
+}
+
 export interface IShape extends IDisposable {
     readonly shapeType: ShapeType;
     get id(): string;
@@ -46,6 +59,12 @@ export interface IShape extends IDisposable {
     reserve(): void;
     clone(): IShape;
     hlr(position: XYZLike, direction: XYZLike, xDir: XYZLike): IShape;
+    /**
+     * Computes every line kind of a drawing view in one run. With a deflection it works on the
+     * triangulation, which is much faster on large shapes, without one it is exact. Unlike hlr, covered
+     * edges are removed from the visible ones.
+     */
+    hlrLines(position: XYZLike, direction: XYZLike, xDir: XYZLike, deflection?: number): HlrLines;
 }
 
 export interface ISubShape extends IShape {
@@ -11,8 +11,18 @@ export interface IShapeConverter {
     convertFromIGES(document: IDocument, iges: Uint8Array): Result<FolderNode>;
     convertToSTEP(...shapes: IShape[]): Result<string>;
     convertFromSTEP(document: IDocument, step: Uint8Array): Result<FolderNode>;
+    /**
+     * Like convertFromSTEP, but reads the file off the main thread where the implementation can.
+     */
+    convertFromSTEPAsync(document: IDocument, step: Uint8Array): Promise<Result<FolderNode>>;
     convertToBrep(shape: IShape): Result<string>;
     convertFromBrep(brep: string): Result<IShape>;
+    /**
+     * The binary BRep, smaller and faster than convertToBrep. The triangulation is kept when withTriangles
+     * is true, so the receiver does not have to mesh the shape again.
+     */
+    convertToBinaryBrep(shape: IShape, withTriangles?: boolean): Result<Uint8Array>;
+    convertFromBinaryBrep(brep: Uint8Array): Result<IShape>;
     convertFromSTL(document: IDocument, stl: Uint8Array): Result<FolderNode>;
     convertFromDXF(document: IDocument, dxf: Uint8Array): Result<FolderNode>;
     convertToDXF(...shapes: IShape[]): Result<string>;
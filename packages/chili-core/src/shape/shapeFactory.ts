@@ -7,6 +7,12 @@ import type { Continuity } from "./curve";
 import type { ICompound, IEdge, IFace, IShape, IShell, ISolid, IVertex, IWire } from "./shape";
 import type { IShapeConverter } from "./shapeConverter";
 
+/**
+ * Receives the position of a long operation in [0, 1] and the name of its current stage, returning
+ * false cancels the operation.
+ */
+export type ProgressCallback = (position: number, stage: string) => boolean | void;
+
 export interface IShapeFactory {
     readonly kernelName: string;
     readonly converter: IShapeConverter;
@@ -40,11 +46,21 @@ export interface IShapeFactory {
     booleanCommon(shape1: IShape[], shape2: IShape[]): Result<IShape>;
     booleanCut(shape1: IShape[], shape2: IShape[]): Result<IShape>;
     booleanFuse(shape1: IShape[], shape2: IShape[]): Result<IShape>;
+    /**
+     * Cuts many tools out of one shape, neighbouring tools are cut together in batches of batchSize,
+     * one batch after another. 0 cuts all of them in one operation.
+     */
+    booleanCutMany(shape: IShape, tools: IShape[], batchSize?: number): Result<IShape>;
     combine(shapes: IShape[]): Result<ICompound>;
-    makeThickSolidBySimple(shape: IShape, thickness: number): Result<IShape>;
-    makeThickSolidByJoin(shape: IShape, closingFaces: IShape[], thickness: number): Result<IShape>;
-    fillet(shape: IShape, edges: number[], radius: number): Result<IShape>;
-    chamfer(shape: IShape, edges: number[], distance: number): Result<IShape>;
+    makeThickSolidBySimple(shape: IShape, thickness: number, onProgress?: ProgressCallback): Result<IShape>;
+    makeThickSolidByJoin(
+        shape: IShape,
+        closingFaces: IShape[],
+        thickness: number,
+        onProgress?: ProgressCallback,
+    ): Result<IShape>;
+    fillet(shape: IShape, edges: number[], radius: number, onProgress?: ProgressCallback): Result<IShape>;
+    chamfer(shape: IShape, edges: number[], distance: number, onProgress?: ProgressCallback): Result<IShape>;
     loft(
         sections: (IVertex | IEdge | IWire)[],
         isSolid: boolean,
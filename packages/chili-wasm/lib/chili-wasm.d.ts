@@ -14,11 +14,32 @@ export interface ShapeNode extends ClassHandle {
     set name(value: EmbindString);
     shape: TopoDS_Shape | undefined;
     color: EmbindString | undefined;
+    prototypeId: number;
+    prototype: TopoDS_Shape | undefined;
+    location: TopLoc_Location;
     getChildren(): Array<ShapeNode>;
 }
 
 export interface Converter extends ClassHandle {}
 
+export interface StepReader extends ClassHandle {
+    isOk(): boolean;
+    isCancelled(): boolean;
+    isDone(): boolean;
+    rootCount(): number;
+    transferredCount(): number;
+    transferNext(): Array<ShapeNode>;
+}
+
+export interface HlrResult extends ClassHandle {
+    visible: TopoDS_Shape;
+    visibleSmooth: TopoDS_Shape;
+    visibleOutline: TopoDS_Shape;
+    hidden: TopoDS_Shape;
+    hiddenSmooth: TopoDS_Shape;
+    hiddenOutline: TopoDS_Shape;
+}
+
 export interface ShapeResult extends ClassHandle {
     isOk: boolean;
     get error(): string;
@@ -37,31 +58,93 @@ export type SurfaceBounds = {
     v2: number;
 };
 
+export type BooleanOptions = {
+    parallel: boolean;
+    fuzzyValue: number;
+    useOBB: boolean;
+    glue: BOPAlgo_GlueEnum;
+    nonDestructive: boolean;
+};
+
 export interface Surface extends ClassHandle {}
 
+export interface MeshCache extends ClassHandle {}
+
+export interface EdgeDiscretizer extends ClassHandle {}
+
+export type MeshOptions = {
+    indexedEdges: boolean;
+    optimizeTriangleOrder: boolean;
+    normals: boolean;
+    uvs: boolean;
+};
+
 export interface Mesher extends ClassHandle {
     mesh(): MeshData;
-    edgesMeshPosition(): Array<number>;
+    meshLods(_0: Array<number>): Array<MeshData>;
+    release(): void;
+    edgesMeshPosition(): Float32Array;
+}
+
+export interface BatchMesher extends ClassHandle {
+    mesh(): MeshData;
+    shapeFaceRanges(): Uint32Array;
+    shapeEdgeRanges(): Uint32Array;
+    release(): void;
+}
+
+export interface MeshContainer extends ClassHandle {
+    isValid(): boolean;
+    shape(): TopoDS_Shape;
+    lineDeflection(): number;
+    meshData(): MeshData;
+    release(): void;
 }
 
 export interface EdgeMeshData extends ClassHandle {
-    position: Array<number>;
-    group: Array<number>;
-    edges: Array<TopoDS_Edge>;
+    readonly position: Float32Array;
+    readonly index: Uint32Array;
+    readonly group: Uint32Array;
+    readonly edges: Array<TopoDS_Edge>;
 }
 
 export interface FaceMeshData extends ClassHandle {
-    position: Array<number>;
-    normal: Array<number>;
-    uv: Array<number>;
-    index: Array<number>;
-    group: Array<number>;
-    faces: Array<TopoDS_Face>;
+    readonly position: Float32Array;
+    readonly normal: Float32Array;
+    readonly uv: Float32Array;
+    readonly index: Uint32Array;
+    readonly group: Uint32Array;
+    readonly faces: Array<TopoDS_Face>;
+    quantize(): QuantizedFaceMesh;
+}
+
+export interface QuantizedFaceMesh extends ClassHandle {
+    readonly position: Uint16Array;
+    readonly normal: Int16Array;
+    readonly uv: Uint16Array;
+    readonly index: Uint16Array | Uint32Array;
+    readonly group: Uint32Array;
+    readonly positionBounds: Float32Array;
+    readonly uvBounds: Float32Array;
 }
 
 export interface MeshData extends ClassHandle {
     edgeMeshData: EdgeMeshData;
     faceMeshData: FaceMeshData;
+    buildBvh(): MeshBvh;
+}
+
+export type MeshBvhHit = {
+    index: number;
+    distance: number;
+    point: Vector3;
+};
+
+export interface MeshBvh extends ClassHandle {
+    raycast(_0: Vector3, _1: Vector3, _2: number): MeshBvhHit | undefined;
+    nearestEdge(_0: Vector3, _1: number): MeshBvhHit | undefined;
+    triangleCount(): number;
+    segmentCount(): number;
 }
 
 export interface GeomAbs_ShapeValue<T extends number> {
@@ -84,6 +167,11 @@ export type GeomAbs_JoinType =
     | GeomAbs_JoinTypeValue<2>
     | GeomAbs_JoinTypeValue<1>;
 
+export interface BOPAlgo_GlueEnumValue<T extends number> {
+    value: T;
+}
+export type BOPAlgo_GlueEnum = BOPAlgo_GlueEnumValue<0> | BOPAlgo_GlueEnumValue<1> | BOPAlgo_GlueEnumValue<2>;
+
 export interface TopAbs_ShapeEnumValue<T extends number> {
     value: T;
 }
@@ -501,6 +589,8 @@ export interface TopoDS_CompSolid extends TopoDS_Shape {}
 
 export interface Shape extends ClassHandle {}
 
+export interface ShapeCache extends ClassHandle {}
+
 export interface Vertex extends ClassHandle {}
 
 export interface Edge extends ClassHandle {}
@@ -561,6 +651,11 @@ export type ProjectPointResult = {
     parameter: number;
 };
 
+export type PointSamples = {
+    points: Float32Array | Float64Array;
+    offsets: Uint32Array;
+};
+
 export type ExtremaCCResult = {
     distance: number;
     p1: Vector3;
@@ -572,33 +667,58 @@ export type ExtremaCCResult = {
 
 export interface Transient extends ClassHandle {}
 
+export interface Trace extends ClassHandle {}
+
 interface EmbindModule {
     ShapeNode: {};
     Converter: {
         convertToBrep(_0: TopoDS_Shape): string;
         convertFromBrep(_0: EmbindString): TopoDS_Shape;
+        convertToBinBrep(_0: TopoDS_Shape, _1: boolean): Uint8Array;
+        convertFromBinBrep(_0: Uint8Array): TopoDS_Shape;
         convertFromStep(_0: Uint8Array): ShapeNode | undefined;
+        convertFromStep(_0: Uint8Array, _1: any): ShapeNode | undefined;
         convertFromIges(_0: Uint8Array): ShapeNode | undefined;
+        convertFromIges(_0: Uint8Array, _1: any): ShapeNode | undefined;
         convertFromStl(_0: Uint8Array): ShapeNode | undefined;
+        convertFromDxf(_0: Uint8Array): ShapeNode | undefined;
         convertToStep(_0: Array<TopoDS_Shape>): string;
         convertToIges(_0: Array<TopoDS_Shape>): string;
     };
+    StepReader: {
+        new (_0: Uint8Array, _1: any): StepReader;
+    };
+    HlrResult: {};
     ShapeResult: {};
     ShapeFactory: {
         makeThickSolidBySimple(_0: TopoDS_Shape, _1: number): ShapeResult;
+        makeThickSolidBySimple(_0: TopoDS_Shape, _1: number, _2: any): ShapeResult;
         simplifyShape(_0: TopoDS_Shape, _1: boolean, _2: boolean): ShapeResult;
         curveProjection(_0: TopoDS_Shape, _1: TopoDS_Shape, _2: gp_Dir): ShapeResult;
         polygon(_0: Array<Vector3>): ShapeResult;
         bezier(_0: Array<Vector3>, _1: Array<number>): ShapeResult;
         fillet(_0: TopoDS_Shape, _1: Array<number>, _2: number): ShapeResult;
+        fillet(_0: TopoDS_Shape, _1: Array<number>, _2: number, _3: any): ShapeResult;
         chamfer(_0: TopoDS_Shape, _1: Array<number>, _2: number): ShapeResult;
+        chamfer(_0: TopoDS_Shape, _1: Array<number>, _2: number, _3: any): ShapeResult;
         sweep(_0: Array<TopoDS_Shape>, _1: TopoDS_Wire, _2: boolean, _3: boolean): ShapeResult;
+        sweep(_0: Array<TopoDS_Shape>, _1: TopoDS_Wire, _2: boolean, _3: boolean, _4: any): ShapeResult;
         makeThickSolidByJoin(_0: TopoDS_Shape, _1: Array<TopoDS_Shape>, _2: number): ShapeResult;
+        makeThickSolidByJoin(_0: TopoDS_Shape, _1: Array<TopoDS_Shape>, _2: number, _3: any): ShapeResult;
         booleanCommon(_0: Array<TopoDS_Shape>, _1: Array<TopoDS_Shape>): ShapeResult;
         booleanCut(_0: Array<TopoDS_Shape>, _1: Array<TopoDS_Shape>): ShapeResult;
         booleanFuse(_0: Array<TopoDS_Shape>, _1: Array<TopoDS_Shape>): ShapeResult;
+        booleanCommon(_0: Array<TopoDS_Shape>, _1: Array<TopoDS_Shape>, _2: BooleanOptions): ShapeResult;
+        booleanCut(_0: Array<TopoDS_Shape>, _1: Array<TopoDS_Shape>, _2: BooleanOptions): ShapeResult;
+        booleanFuse(_0: Array<TopoDS_Shape>, _1: Array<TopoDS_Shape>, _2: BooleanOptions): ShapeResult;
+        booleanCommon(_0: Array<TopoDS_Shape>, _1: Array<TopoDS_Shape>, _2: BooleanOptions, _3: any): ShapeResult;
+        booleanCut(_0: Array<TopoDS_Shape>, _1: Array<TopoDS_Shape>, _2: BooleanOptions, _3: any): ShapeResult;
+        booleanFuse(_0: Array<TopoDS_Shape>, _1: Array<TopoDS_Shape>, _2: BooleanOptions, _3: any): ShapeResult;
+        booleanCutMany(_0: TopoDS_Shape, _1: Array<TopoDS_Shape>, _2: number, _3: BooleanOptions): ShapeResult;
+        booleanCutMany(_0: TopoDS_Shape, _1: Array<TopoDS_Shape>, _2: number, _3: BooleanOptions, _4: any): ShapeResult;
         combine(_0: Array<TopoDS_Shape>): ShapeResult;
         loft(_0: Array<TopoDS_Shape>, _1: boolean, _2: boolean, _3: GeomAbs_Shape): ShapeResult;
+        loft(_0: Array<TopoDS_Shape>, _1: boolean, _2: boolean, _3: GeomAbs_Shape, _4: any): ShapeResult;
         wire(_0: Array<TopoDS_Edge>): ShapeResult;
         shell(_0: Array<TopoDS_Face>): ShapeResult;
         face(_0: Array<TopoDS_Wire>): ShapeResult;
@@ -623,11 +743,15 @@ interface EmbindModule {
         trim(_0: Geom_Curve | null, _1: number, _2: number): Handle_Geom_TrimmedCurve;
         uniformAbscissaWithCount(_0: Geom_Curve | null, _1: number): Array<Vector3>;
         uniformAbscissaWithLength(_0: Geom_Curve | null, _1: number): Array<Vector3>;
+        uniformAbscissaBatchWithCount(_0: Array<Geom_Curve>, _1: number): PointSamples;
+        uniformAbscissaBatchWithLength(_0: Array<Geom_Curve>, _1: number): PointSamples;
         makeLine(_0: Vector3, _1: Vector3): Handle_Geom_Line;
         parameter(_0: Geom_Curve | null, _1: Vector3, _2: number): number | undefined;
         projects(_0: Geom_Curve | null, _1: Vector3): Array<Vector3>;
         projectOrNearest(_0: Geom_Curve | null, _1: Vector3): ProjectPointResult;
         nearestExtremaCC(_0: Geom_Curve | null, _1: Geom_Curve | null): ExtremaCCResult | undefined;
+        projectOrNearestBatch(_0: Geom_Curve | null, _1: Float64Array): Float64Array;
+        parameterBatch(_0: Geom_Curve | null, _1: Float64Array, _2: number): Float64Array;
     };
     Surface: {
         isPlanar(_0: Geom_Surface | null): boolean;
@@ -636,13 +760,39 @@ interface EmbindModule {
         projectPoint(_0: Geom_Surface | null, _1: Vector3): Array<Vector3>;
         parameters(_0: Geom_Surface | null, _1: Vector3, _2: number): UV | undefined;
         nearestPoint(_0: Geom_Surface | null, _1: Vector3): PointAndParameter | undefined;
+        projectPointBatch(_0: Geom_Surface | null, _1: Float64Array): Float64Array;
+        parametersBatch(_0: Geom_Surface | null, _1: Float64Array, _2: number): Float64Array;
     };
     Mesher: {
         new (_0: TopoDS_Shape, _1: number): Mesher;
+        new (_0: TopoDS_Shape, _1: number, _2: MeshOptions): Mesher;
+    };
+    BatchMesher: {
+        new (_0: Array<TopoDS_Shape>, _1: number): BatchMesher;
+        new (_0: Array<TopoDS_Shape>, _1: number, _2: MeshOptions): BatchMesher;
+    };
+    MeshContainer: {
+        new (_0: Uint8Array): MeshContainer;
+        write(_0: TopoDS_Shape, _1: number): Uint8Array;
+    };
+    EdgeDiscretizer: {
+        clear(): void;
+        setCapacity(_0: number): void;
+        size(): number;
+    };
+    MeshCache: {
+        clear(): void;
+        prune(): void;
+        setCapacity(_0: number): void;
+        size(): number;
+        triangleCount(): number;
+        restoredCount(): number;
     };
     EdgeMeshData: {};
+    QuantizedFaceMesh: {};
     FaceMeshData: {};
     MeshData: {};
+    MeshBvh: {};
     GeomAbs_Shape: {
         GeomAbs_C0: GeomAbs_ShapeValue<0>;
         GeomAbs_C1: GeomAbs_ShapeValue<2>;
@@ -657,6 +807,11 @@ interface EmbindModule {
         GeomAbs_Intersection: GeomAbs_JoinTypeValue<2>;
         GeomAbs_Tangent: GeomAbs_JoinTypeValue<1>;
     };
+    BOPAlgo_GlueEnum: {
+        BOPAlgo_GlueOff: BOPAlgo_GlueEnumValue<0>;
+        BOPAlgo_GlueShift: BOPAlgo_GlueEnumValue<1>;
+        BOPAlgo_GlueFull: BOPAlgo_GlueEnumValue<2>;
+    };
     TopAbs_ShapeEnum: {
         TopAbs_VERTEX: TopAbs_ShapeEnumValue<7>;
         TopAbs_EDGE: TopAbs_ShapeEnumValue<6>;
@@ -781,15 +936,26 @@ interface EmbindModule {
         isClosed(_0: TopoDS_Shape): boolean;
         replaceSubShape(_0: TopoDS_Shape, _1: TopoDS_Shape, _2: TopoDS_Shape): TopoDS_Shape;
         hlr(_0: TopoDS_Shape, _1: gp_Pnt, _2: gp_Dir, _3: gp_Dir): TopoDS_Shape;
+        hlrExact(_0: TopoDS_Shape, _1: gp_Pnt, _2: gp_Dir, _3: gp_Dir): HlrResult;
+        hlrPolygonal(_0: TopoDS_Shape, _1: gp_Pnt, _2: gp_Dir, _3: gp_Dir, _4: number): HlrResult;
+        hlrPolygonal(_0: TopoDS_Shape, _1: gp_Pnt, _2: gp_Dir, _3: gp_Dir, _4: number, _5: any): HlrResult;
         sewing(_0: TopoDS_Shape, _1: TopoDS_Shape): TopoDS_Shape;
         findAncestor(_0: TopoDS_Shape, _1: TopoDS_Shape, _2: TopAbs_ShapeEnum): Array<TopoDS_Shape>;
         findSubShapes(_0: TopoDS_Shape, _1: TopAbs_ShapeEnum): Array<TopoDS_Shape>;
         iterShape(_0: TopoDS_Shape): Array<TopoDS_Shape>;
         splitShapes(_0: Array<TopoDS_Shape>, _1: Array<TopoDS_Shape>): TopoDS_Shape;
         removeFeature(_0: TopoDS_Shape, _1: Array<TopoDS_Shape>): TopoDS_Shape;
+        removeFeature(_0: TopoDS_Shape, _1: Array<TopoDS_Shape>, _2: any): TopoDS_Shape;
         removeSubShape(_0: TopoDS_Shape, _1: Array<TopoDS_Shape>): TopoDS_Shape;
         sectionSP(_0: TopoDS_Shape, _1: Pln): TopoDS_Shape;
     };
+    ShapeCache: {
+        invalidate(_0: TopoDS_Shape): void;
+        prune(): void;
+        clear(): void;
+        setCapacity(_0: number): void;
+        size(): number;
+    };
     Vertex: {
         point(_0: TopoDS_Vertex): Vector3;
     };
@@ -800,6 +966,7 @@ interface EmbindModule {
         trim(_0: TopoDS_Edge, _1: number, _2: number): TopoDS_Edge;
         offset(_0: TopoDS_Edge, _1: gp_Dir, _2: number): TopoDS_Edge;
         intersect(_0: TopoDS_Edge, _1: TopoDS_Edge): Array<PointAndParameter>;
+        polylines(_0: Array<TopoDS_Edge>, _1: number): PointSamples;
     };
     Wire: {
         offset(_0: TopoDS_Wire, _1: number, _2: GeomAbs_JoinType): TopoDS_Shape;
@@ -817,6 +984,13 @@ interface EmbindModule {
     Solid: {
         volume(_0: TopoDS_Solid): number;
     };
+    Trace: {
+        enabled(): boolean;
+        clear(): void;
+        chromeTrace(): string;
+        stages(): any;
+        counters(): any;
+    };
     Transient: {
         isKind(_0: Standard_Transient | null, _1: EmbindString): boolean;
         isInstance(_0: Standard_Transient | null, _1: EmbindString): boolean;
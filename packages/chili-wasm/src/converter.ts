@@ -11,27 +11,61 @@ import {
     type IDocument,
     type IShape,
     type IShapeConverter,
+    Logger,
     Material,
+    Matrix4,
     Result,
 } from "chili-core";
 import type { ShapeNode } from "../lib/chili-wasm";
 import { OcctHelper } from "./helper";
+import { Mesher } from "./mesher";
 import { OccShape } from "./shape";
+import { WasmWorkerPool } from "./worker-pool";
+import type { ImportedNode } from "./worker-protocol";
+
+/**
+ * The shapes created by one import. Nodes that are instances of an XCAF prototype wrap the unlocated
+ * prototype and carry the instance location as their transform, so only the first instance is meshed.
+ */
+interface ImportContext {
+    shapes: OccShape[];
+    prototypes: Map<number, OccShape>;
+    instances: [prototype: OccShape, instance: OccShape][];
+}
 
 export class OccShapeConverter implements IShapeConverter {
+    private workerPool?: WasmWorkerPool;
+
     private readonly addShapeNode = (
         collector: (d: Deletable | IDisposable) => any,
         folder: FolderNode,
         node: ShapeNode,
         children: ShapeNode[],
         getMaterialId: (document: IDocument, color: string) => string,
+        context: ImportContext,
     ) => {
         if (node.shape && !node.shape.isNull()) {
-            const shape = OcctHelper.wrapShape(node.shape);
             const material = getMaterialId(folder.document, node.color as string);
-            folder.add(new EditableShapeNode(folder.document, node.name, shape, material));
+            const prototype = node.prototypeId >= 0 ? node.prototype : undefined;
+            const shape = OcctHelper.wrapShape(prototype ?? node.shape);
+            const shapeNode = new EditableShapeNode(folder.document, node.name, shape, material);
+            if (prototype) {
+                shapeNode.transform = this.locationToMatrix(collector, node);
+            }
+            folder.add(shapeNode);
+            this.registerShape(context, shape, prototype ? node.prototypeId : undefined);
         }
 
+        this.addChildNodes(collector, folder, children, getMaterialId, context);
+    };
+
+    private readonly addChildNodes = (
+        collector: (d: Deletable | IDisposable) => any,
+        folder: FolderNode,
+        children: ShapeNode[],
+        getMaterialId: (document: IDocument, color: string) => string,
+        context: ImportContext,
+    ) => {
         children.forEach((child) => {
             collector(child);
             const subChildren = child.getChildren();
@@ -40,7 +74,7 @@ export class OccShapeConverter implements IShapeConverter {
             if (subChildren.length > 1) {
                 folder.add(childFolder);
             }
-            this.addShapeNode(collector, childFolder, child, subChildren, getMaterialId);
+            this.addShapeNode(collector, childFolder, child, subChildren, getMaterialId, context);
         });
     };
 
@@ -58,13 +92,45 @@ export class OccShapeConverter implements IShapeConverter {
         return this.converterFromData(document, iges, wasm.Converter.convertFromIges);
     }
 
-    private readonly converterFromData = (
-        document: IDocument,
-        data: Uint8Array,
-        converter: (data: Uint8Array) => ShapeNode | undefined,
-    ) => {
+    private locationToMatrix(collector: (d: Deletable | IDisposable) => any, node: ShapeNode) {
+        const location = collector(node.location);
+        const transformation = collector(location.transformation());
+        return OcctHelper.convertToMatrix(transformation);
+    }
+
+    private registerShape(context: ImportContext, shape: IShape, prototypeId?: number) {
+        if (!(shape instanceof OccShape)) {
+            return;
+        }
+        const prototype = prototypeId === undefined ? undefined : context.prototypes.get(prototypeId);
+        if (prototype) {
+            context.instances.push([prototype, shape]);
+            return;
+        }
+        if (prototypeId !== undefined) {
+            context.prototypes.set(prototypeId, shape);
+        }
+        context.shapes.push(shape);
+    }
+
+    /**
+     * Imported parts are shown right away, meshing them in one batch avoids one wasm.Mesher per part.
+     * Instances then take the buffers of their prototype.
+     */
+    private meshShapes(context: ImportContext) {
+        Mesher.meshShapes(context.shapes);
+        context.instances.forEach(([prototype, instance]) => Mesher.shareMesh(prototype, instance));
+        context.shapes = [];
+        context.instances = [];
+    }
+
+    private createImportContext(): ImportContext {
+        return { shapes: [], prototypes: new Map(), instances: [] };
+    }
+
+    private materialResolver() {
         const materialMap: Map<string, string> = new Map();
-        const getMaterialId = (document: IDocument, color: string) => {
+        return (document: IDocument, color: string) => {
             // Provide default color for undefined, null, or empty color values
             const materialColor = color || "#808080"; // Default gray color
             const materialKey = materialColor;
@@ -76,15 +142,24 @@ export class OccShapeConverter implements IShapeConverter {
             }
             return materialMap.get(materialKey)!;
         };
+    }
 
+    private readonly converterFromData = (
+        document: IDocument,
+        data: Uint8Array,
+        converter: (data: Uint8Array) => ShapeNode | undefined,
+    ) => {
+        const getMaterialId = this.materialResolver();
         return gc((c) => {
             const node = converter(data);
             if (!node) {
                 return Result.err("can not convert");
             }
             const folder = new GroupNode(document, "undefined");
-            this.addShapeNode(c, folder, node, node.getChildren(), getMaterialId);
+            const context = this.createImportContext();
+            this.addShapeNode(c, folder, node, node.getChildren(), getMaterialId, context);
             c(node);
+            this.meshShapes(context);
             return Result.ok(folder);
         });
     };
@@ -103,6 +178,102 @@ export class OccShapeConverter implements IShapeConverter {
         return this.converterFromData(document, step, wasm.Converter.convertFromStep);
     }
 
+    /**
+     * Reads the file in a WasmWorkerPool worker, so the main thread stays responsive and the parts arrive
+     * meshed. Falls back to convertFromSTEP where workers are not available or the worker fails.
+     */
+    async convertFromSTEPAsync(document: IDocument, step: Uint8Array): Promise<Result<FolderNode>> {
+        if (typeof Worker === "undefined") {
+            return this.convertFromSTEP(document, step);
+        }
+
+        this.workerPool ??= new WasmWorkerPool();
+        let node: ImportedNode | undefined;
+        try {
+            node = await this.workerPool.importStep(step);
+        } catch (e) {
+            Logger.warn(`STEP import in a worker failed, reading it on the main thread: ${e}`);
+            return this.convertFromSTEP(document, step);
+        }
+        return node ? this.convertFromImportedNode(document, node) : Result.err("can not convert");
+    }
+
+    /**
+     * Imports a STEP file root by root into `folder`, yielding to the event loop between roots so the
+     * parts already added can be rendered. `onProgress` receives the position in [0, 1]; returning
+     * false from it cancels the import.
+     */
+    async convertFromSTEPProgressive(
+        folder: FolderNode,
+        step: Uint8Array,
+        onProgress?: (position: number, stage: string) => boolean | void,
+    ): Promise<Result<FolderNode>> {
+        const reader = new wasm.StepReader(step, onProgress);
+        try {
+            if (!reader.isOk()) {
+                return Result.err("can not convert");
+            }
+
+            const getMaterialId = this.materialResolver();
+            const context = this.createImportContext();
+            while (!reader.isDone()) {
+                gc((c) => this.addChildNodes(c, folder, reader.transferNext(), getMaterialId, context));
+                this.meshShapes(context);
+                await new Promise((resolve) => setTimeout(resolve));
+            }
+            return reader.isCancelled() ? Result.err("cancelled") : Result.ok(folder);
+        } finally {
+            reader.delete();
+        }
+    }
+
+    /**
+     * Builds the nodes of an import run by WasmWorkerPool.importStep or importIges. The shapes arrive
+     * meshed, instances take the mesh of their prototype.
+     */
+    convertFromImportedNode(document: IDocument, node: ImportedNode): Result<FolderNode> {
+        const folder = new GroupNode(document, "undefined");
+        const context = this.createImportContext();
+        this.addImportedNode(folder, node, this.materialResolver(), context);
+        this.meshShapes(context);
+        return Result.ok(folder);
+    }
+
+    private addImportedNode(
+        folder: FolderNode,
+        node: ImportedNode,
+        getMaterialId: (document: IDocument, color: string) => string,
+        context: ImportContext,
+    ) {
+        const shape = this.importedShape(context, node);
+        if (shape) {
+            const material = getMaterialId(folder.document, node.color as string);
+            const shapeNode = new EditableShapeNode(folder.document, node.name, shape, material);
+            if (node.matrix) {
+                shapeNode.transform = Matrix4.fromArray(node.matrix);
+            }
+            folder.add(shapeNode);
+            this.registerShape(context, shape, node.prototypeId >= 0 ? node.prototypeId : undefined);
+        }
+
+        node.children.forEach((child) => {
+            const hasFolder = child.children.length > 1;
+            const childFolder = hasFolder ? new GroupNode(folder.document, child.name) : folder;
+            if (hasFolder) {
+                folder.add(childFolder);
+            }
+            this.addImportedNode(childFolder, child, getMaterialId, context);
+        });
+    }
+
+    private importedShape(context: ImportContext, node: ImportedNode) {
+        if (node.shape) {
+            return Mesher.unpack(node.shape);
+        }
+        const prototype = node.matrix ? context.prototypes.get(node.prototypeId) : undefined;
+        return prototype ? (OcctHelper.wrapShape(prototype.shape) as OccShape) : undefined;
+    }
+
     convertToBrep(shape: IShape): Result<string> {
         if (shape instanceof OccShape) {
             return Result.ok(wasm.Converter.convertToBrep(shape.shape));
@@ -118,13 +289,43 @@ export class OccShapeConverter implements IShapeConverter {
         return Result.ok(OcctHelper.wrapShape(shape));
     }
 
+    convertToBinaryBrep(shape: IShape, withTriangles: boolean = false): Result<Uint8Array> {
+        if (shape instanceof OccShape) {
+            return Result.ok(wasm.Converter.convertToBinBrep(shape.shape, withTriangles));
+        }
+        return Result.err("Shape is not an OccShape");
+    }
+
+    convertFromBinaryBrep(brep: Uint8Array): Result<IShape> {
+        const shape = wasm.Converter.convertFromBinBrep(brep);
+        if (shape.isNull()) {
+            return Result.err("can not convert");
+        }
+        return Result.ok(OcctHelper.wrapShape(shape));
+    }
+
     convertFromSTL(document: IDocument, stl: Uint8Array): Result<FolderNode> {
         return this.converterFromData(document, stl, wasm.Converter.convertFromStl);
     }
 
+    /**
+     * The root node of wasm.Converter.convertFromDxf has no shape, every layer becomes a shape node of
+     * its own in a folder named after the import, also when the file has a single layer.
+     */
     convertFromDXF(document: IDocument, dxf: Uint8Array): Result<FolderNode> {
-        // DXF conversion is not yet implemented in the WASM module
-        return Result.err("DXF import is not yet implemented");
+        const getMaterialId = this.materialResolver();
+        return gc((c) => {
+            const node = wasm.Converter.convertFromDxf(dxf);
+            if (!node) {
+                return Result.err("can not convert");
+            }
+            c(node);
+            const folder = new GroupNode(document, node.name);
+            const context = this.createImportContext();
+            this.addChildNodes(c, folder, node.getChildren(), getMaterialId, context);
+            this.meshShapes(context);
+            return Result.ok(folder);
+        });
     }
 
     convertToDXF(...shapes: IShape[]): Result<string> {
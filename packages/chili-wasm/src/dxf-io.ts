@@ -1,9 +1,8 @@
 // Part of the Chili3d Project, under the AGPL-3.0 License.
 // See LICENSE file in the project root for full license information.
 
-import { type IDocument, type IShape, Result, ShapeType } from "chili-core";
+import { type FolderNode, type IDocument, type IShape, Result, ShapeNode, ShapeType } from "chili-core";
 import { ShapeFactory } from "./factory";
-import { OcctHelper } from "./helper";
 
 /**
  * DXF File I/O Operations
@@ -224,23 +223,14 @@ export class DxfIO {
     /**
      * Helper method to extract shapes from folder node
      */
-    private extractShapesFromFolder(folderNode: any): IShape[] {
+    private extractShapesFromFolder(folderNode: FolderNode): IShape[] {
+        // convertFromDXF puts one shape node per layer into the folder
         const shapes: IShape[] = [];
-
-        // Recursively extract all shapes from the folder structure
-        const extractFromNode = (node: any) => {
-            if (node.shape && !node.shape.isNull()) {
-                shapes.push(OcctHelper.wrapShape(node.shape));
-            }
-
-            if (node.children && node.children.length > 0) {
-                for (const child of node.children) {
-                    extractFromNode(child);
-                }
+        for (const node of folderNode.children()) {
+            if (node instanceof ShapeNode && node.shape.isOk) {
+                shapes.push(node.shape.value);
             }
-        };
-
-        extractFromNode(folderNode);
+        }
         return shapes;
     }
 
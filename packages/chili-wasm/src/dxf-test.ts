@@ -75,7 +75,7 @@ EOF`;
         const result = factory.converter.convertFromDXF(mockDocument, dxfBytes);
 
         if (result.isOk) {
-            return Result.ok("DXF import test successful! Imported " + result.value.children.length + " shapes.");
+            return Result.ok("DXF import test successful! Imported " + result.value.children().length + " layers.");
         } else {
             return Result.err("DXF import test failed: " + result.error);
         }
@@ -97,7 +97,8 @@ export function importDxfFile(document: any, dxfFile: File): Promise<Result<stri
                 const result = factory.converter.convertFromDXF(document, dxfBytes);
                 
                 if (result.isOk) {
-                    resolve(Result.ok("Successfully imported DXF file with " + result.value.children.length + " shapes"));
+                    const layers = result.value.children().length;
+                    resolve(Result.ok("Successfully imported DXF file with " + layers + " layers"));
                 } else {
                     resolve(Result.err("Failed to import DXF file: " + result.error));
                 }
@@ -17,13 +17,14 @@ import {
     MathUtils,
     type Plane,
     Precision,
+    type ProgressCallback,
     Result,
     ShapeType,
     type XYZ,
     type XYZLike,
 } from "chili-core";
 import { GeoUtils } from "chili-geo";
-import type { ShapeResult, TopoDS_Shape } from "../lib/chili-wasm";
+import type { BooleanOptions, ShapeResult, TopoDS_Shape } from "../lib/chili-wasm";
 import { OccShapeConverter } from "./converter";
 import { OcctHelper } from "./helper";
 import { OccShape } from "./shape";
@@ -67,7 +68,7 @@ export class ShapeFactory implements IShapeFactory {
         this.converter = new OccShapeConverter();
     }
 
-    fillet(shape: IShape, edges: number[], radius: number): Result<IShape> {
+    fillet(shape: IShape, edges: number[], radius: number, onProgress?: ProgressCallback): Result<IShape> {
         if (radius < Precision.Distance) {
             return Result.err("The radius is too small.");
         }
@@ -77,12 +78,12 @@ export class ShapeFactory implements IShapeFactory {
         }
 
         if (shape instanceof OccShape) {
-            return convertShapeResult(wasm.ShapeFactory.fillet(shape.shape, edges, radius));
+            return convertShapeResult(wasm.ShapeFactory.fillet(shape.shape, edges, radius, onProgress));
         }
         return Result.err("Not OccShape");
     }
 
-    chamfer(shape: IShape, edges: number[], distance: number): Result<IShape> {
+    chamfer(shape: IShape, edges: number[], distance: number, onProgress?: ProgressCallback): Result<IShape> {
         if (distance < Precision.Distance) {
             return Result.err("The distance is too small.");
         }
@@ -92,7 +93,7 @@ export class ShapeFactory implements IShapeFactory {
         }
 
         if (shape instanceof OccShape) {
-            return convertShapeResult(wasm.ShapeFactory.chamfer(shape.shape, edges, distance));
+            return convertShapeResult(wasm.ShapeFactory.chamfer(shape.shape, edges, distance, onProgress));
         }
         return Result.err("Not OccShape");
     }
@@ -273,6 +274,18 @@ export class ShapeFactory implements IShapeFactory {
             wasm.ShapeFactory.booleanCut(ensureOccShape(shape1), ensureOccShape(shape2)),
         );
     }
+    booleanCutMany(shape: IShape, tools: IShape[], batchSize = 0): Result<IShape> {
+        const options: BooleanOptions = {
+            parallel: true,
+            fuzzyValue: 0,
+            useOBB: true,
+            glue: wasm.BOPAlgo_GlueEnum.BOPAlgo_GlueOff,
+            nonDestructive: false,
+        };
+        return convertShapeResult(
+            wasm.ShapeFactory.booleanCutMany(ensureOccShape(shape)[0], ensureOccShape(tools), batchSize, options),
+        );
+    }
     booleanFuse(shape1: IShape[], shape2: IShape[]): Result<IShape> {
         const fused = wasm.ShapeFactory.booleanFuse(ensureOccShape(shape1), ensureOccShape(shape2));
         if (!fused.isOk) {
@@ -284,17 +297,23 @@ export class ShapeFactory implements IShapeFactory {
     combine(shapes: IShape[]): Result<ICompound> {
         return convertShapeResult(wasm.ShapeFactory.combine(ensureOccShape(shapes))) as Result<ICompound>;
     }
-    makeThickSolidBySimple(shape: IShape, thickness: number): Result<IShape> {
+    makeThickSolidBySimple(shape: IShape, thickness: number, onProgress?: ProgressCallback): Result<IShape> {
         return convertShapeResult(
-            wasm.ShapeFactory.makeThickSolidBySimple(ensureOccShape(shape)[0], thickness),
+            wasm.ShapeFactory.makeThickSolidBySimple(ensureOccShape(shape)[0], thickness, onProgress),
         );
     }
-    makeThickSolidByJoin(shape: IShape, closingFaces: IShape[], thickness: number): Result<IShape> {
+    makeThickSolidByJoin(
+        shape: IShape,
+        closingFaces: IShape[],
+        thickness: number,
+        onProgress?: ProgressCallback,
+    ): Result<IShape> {
         return convertShapeResult(
             wasm.ShapeFactory.makeThickSolidByJoin(
                 ensureOccShape(shape)[0],
                 ensureOccShape(closingFaces),
                 thickness,
+                onProgress,
             ),
         );
     }
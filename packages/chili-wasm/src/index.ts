@@ -9,4 +9,6 @@ export { DxfLayerManager, type DxfLayer } from "./dxf-layer";
 export * from "./dxf-test";
 export * from "./factory";
 export * from "./wasm";
+export * from "./worker-pool";
+export type { ImportedNode } from "./worker-protocol";
 
@@ -11,10 +11,131 @@ import {
     type ShapeMeshRange,
     VisualConfig,
 } from "chili-core";
-import type { EdgeMeshData as OccEdgeMeshData, FaceMeshData as OccFaceMeshData } from "../lib/chili-wasm";
+import type {
+    EdgeMeshData as OccEdgeMeshData,
+    FaceMeshData as OccFaceMeshData,
+    TopoDS_Shape,
+} from "../lib/chili-wasm";
+import { OcctHelper } from "./helper";
 import { type OccShape, OccSubEdgeShape, OccSubFaceShape } from "./shape";
 
+export const LINE_DEFLECTION = 0.005;
+
+type FaceBuffers = {
+    position: Float32Array;
+    normal: Float32Array;
+    uv: Float32Array;
+    index: Uint32Array;
+    group: Uint32Array;
+};
+
 export class Mesher implements IShapeMeshData, IDisposable {
+    /**
+     * Meshes all shapes that are not meshed yet with one wasm.BatchMesher call and hands every shape
+     * its own slice of the packed buffers, instead of one wasm.Mesher per shape.
+     */
+    static meshShapes(shapes: OccShape[]) {
+        const meshers = shapes
+            .map((shape) => shape.mesh)
+            .filter((mesh): mesh is Mesher => mesh instanceof Mesher && !mesh._isMeshed);
+        if (meshers.length === 0) {
+            return;
+        }
+
+        gc((c) => {
+            const batch = c(new wasm.BatchMesher(meshers.map((m) => m.shape.shape), LINE_DEFLECTION));
+            const meshData = c(batch.mesh());
+            const faceMeshData = c(meshData.faceMeshData);
+            const edgeMeshData = c(meshData.edgeMeshData);
+            const faceRanges = batch.shapeFaceRanges().slice();
+            const edgeRanges = batch.shapeEdgeRanges().slice();
+            const faces = Mesher.copyFaceBuffers(faceMeshData);
+            const edges = { position: edgeMeshData.position.slice(), group: edgeMeshData.group.slice() };
+            const faceShapes = faceMeshData.faces;
+            const edgeShapes = edgeMeshData.edges;
+
+            meshers.forEach((mesher, i) => {
+                mesher._isMeshed = true;
+                const [firstFace, faceCount, firstNode, nodeCount] = faceRanges.subarray(i * 4, i * 4 + 4);
+                mesher._faces = mesher.sliceFaceMeshData(faces, faceShapes, firstFace, faceCount, firstNode, nodeCount);
+                const [firstEdge, edgeCount] = edgeRanges.subarray(i * 2, i * 2 + 2);
+                mesher._lines = mesher.sliceEdgeMeshData(edges, edgeShapes, firstEdge, edgeCount);
+            });
+        });
+    }
+
+    /**
+     * Packs the shape and its mesh into a wasm.MeshContainer buffer that unpack reopens without meshing again.
+     */
+    static pack(shape: OccShape): Uint8Array {
+        return wasm.MeshContainer.write(shape.shape, LINE_DEFLECTION);
+    }
+
+    /**
+     * Reopens a buffer written by pack, undefined when it is not a container this build can read.
+     */
+    static unpack(data: Uint8Array): OccShape | undefined {
+        return gc((c) => {
+            const container = c(new wasm.MeshContainer(data));
+            if (!container.isValid()) {
+                return undefined;
+            }
+
+            const shape = OcctHelper.wrapShape(container.shape()) as OccShape;
+            const mesher = shape.mesh;
+            if (mesher instanceof Mesher) {
+                const meshData = c(container.meshData());
+                mesher._isMeshed = true;
+                mesher._faces = mesher.parseFaceMeshData(c(meshData.faceMeshData));
+                mesher._lines = mesher.parseEdgeMeshData(c(meshData.edgeMeshData));
+            }
+            return shape;
+        });
+    }
+
+    /**
+     * Gives an instance of an XCAF prototype the buffers of the prototype mesh. Both wrap the same
+     * unlocated shape, the instance is placed by its node transform. The sub shapes are copied because
+     * disposing a shape nullifies its handles.
+     */
+    static shareMesh(source: OccShape, target: OccShape) {
+        const mesher = target.mesh;
+        const faces = source.mesh.faces;
+        const edges = source.mesh.edges;
+        if (!(mesher instanceof Mesher) || mesher._isMeshed || !faces || !edges) {
+            return;
+        }
+
+        mesher._isMeshed = true;
+        gc((c) => {
+            const copy = <T extends TopoDS_Shape>(shape: T) => shape.located(c(shape.getLocation()), false) as T;
+            mesher._faces = {
+                ...faces,
+                range: faces.range.map((r, i) => ({
+                    ...r,
+                    shape: new OccSubFaceShape(target, wasm.TopoDS.face(copy((r.shape as OccSubFaceShape).shape)), i),
+                })),
+            };
+            mesher._lines = {
+                ...edges,
+                range: edges.range.map((r, i) => ({
+                    ...r,
+                    shape: new OccSubEdgeShape(target, wasm.TopoDS.edge(copy((r.shape as OccSubEdgeShape).shape)), i),
+                })),
+            };
+        });
+    }
+
+    private static copyFaceBuffers(data: OccFaceMeshData): FaceBuffers {
+        return {
+            position: data.position.slice(),
+            normal: data.normal.slice(),
+            uv: data.uv.slice(),
+            index: data.index.slice(),
+            group: data.group.slice(),
+        };
+    }
+
     private _isMeshed = false;
     private _lines?: EdgeMeshData;
     private _faces?: FaceMeshData;
@@ -41,6 +162,10 @@ export class Mesher implements IShapeMeshData, IDisposable {
 
     constructor(private shape: OccShape) {}
 
+    /**
+     * The buffers of a wasm.MeshData are views into the wasm heap. They live as long as the MeshData,
+     * but are detached when the heap grows, so every view is copied before the next call into wasm.
+     */
     private mesh() {
         if (this._isMeshed) {
             return;
@@ -48,7 +173,7 @@ export class Mesher implements IShapeMeshData, IDisposable {
         this._isMeshed = true;
 
         gc((c) => {
-            const occMesher = c(new wasm.Mesher(this.shape.shape, 0.005));
+            const occMesher = c(new wasm.Mesher(this.shape.shape, LINE_DEFLECTION));
             const meshData = c(occMesher.mesh());
             const faceMeshData = c(meshData.faceMeshData);
             const edgeMeshData = c(meshData.edgeMeshData);
@@ -70,6 +195,64 @@ export class Mesher implements IShapeMeshData, IDisposable {
         };
     }
 
+    private sliceFaceMeshData(
+        data: FaceBuffers,
+        faces: OccFaceMeshData["faces"],
+        firstFace: number,
+        faceCount: number,
+        firstNode: number,
+        nodeCount: number,
+    ): FaceMeshData {
+        const indexStart = faceCount > 0 ? data.group[2 * firstFace] : 0;
+        const lastFace = firstFace + faceCount - 1;
+        const indexEnd = faceCount > 0 ? data.group[2 * lastFace] + data.group[2 * lastFace + 1] : 0;
+        const index = data.index.slice(indexStart, indexEnd).map((i) => i - firstNode);
+        const range: ShapeMeshRange[] = [];
+        for (let i = 0; i < faceCount; i++) {
+            const face = firstFace + i;
+            range.push({
+                start: data.group[2 * face] - indexStart,
+                count: data.group[2 * face + 1],
+                shape: new OccSubFaceShape(this.shape, faces[face], i),
+            });
+        }
+        return {
+            position: data.position.slice(firstNode * 3, (firstNode + nodeCount) * 3),
+            normal: data.normal.slice(firstNode * 3, (firstNode + nodeCount) * 3),
+            uv: data.uv.slice(firstNode * 2, (firstNode + nodeCount) * 2),
+            index,
+            range,
+            color: VisualConfig.defaultFaceColor,
+            groups: [],
+        };
+    }
+
+    private sliceEdgeMeshData(
+        data: { position: Float32Array; group: Uint32Array },
+        edges: OccEdgeMeshData["edges"],
+        firstEdge: number,
+        edgeCount: number,
+    ): EdgeMeshData {
+        const pointStart = edgeCount > 0 ? data.group[2 * firstEdge] : 0;
+        const lastEdge = firstEdge + edgeCount - 1;
+        const pointEnd = edgeCount > 0 ? data.group[2 * lastEdge] + data.group[2 * lastEdge + 1] : 0;
+        const range: ShapeMeshRange[] = [];
+        for (let i = 0; i < edgeCount; i++) {
+            const edge = firstEdge + i;
+            range.push({
+                start: data.group[2 * edge] - pointStart,
+                count: data.group[2 * edge + 1],
+                shape: new OccSubEdgeShape(this.shape, edges[edge], i),
+            });
+        }
+        return {
+            lineType: LineType.Solid,
+            position: data.position.slice(pointStart * 3, pointEnd * 3),
+            range,
+            color: VisualConfig.defaultEdgeColor,
+        };
+    }
+
     private parseEdgeMeshData(edgeMeshData: OccEdgeMeshData): EdgeMeshData {
         return {
             lineType: LineType.Solid,
@@ -89,24 +272,29 @@ export class Mesher implements IShapeMeshData, IDisposable {
     }
 
     private getEdgeRanges(data: OccEdgeMeshData): ShapeMeshRange[] {
+        // group is a view into the wasm heap, copy it before creating the sub shapes
+        const group = data.group.slice();
+        const edges = data.edges;
         const result: ShapeMeshRange[] = [];
-        for (let i = 0; i < data.edges.length; i++) {
+        for (let i = 0; i < edges.length; i++) {
             result.push({
-                start: data.group[2 * i],
-                count: data.group[2 * i + 1],
-                shape: new OccSubEdgeShape(this.shape, data.edges[i], i),
+                start: group[2 * i],
+                count: group[2 * i + 1],
+                shape: new OccSubEdgeShape(this.shape, edges[i], i),
             });
         }
         return result;
     }
 
     private getFaceRanges(data: OccFaceMeshData): ShapeMeshRange[] {
+        const group = data.group.slice();
+        const faces = data.faces;
         const result: ShapeMeshRange[] = [];
-        for (let i = 0; i < data.faces.length; i++) {
+        for (let i = 0; i < faces.length; i++) {
             result.push({
-                start: data.group[2 * i],
-                count: data.group[2 * i + 1],
-                shape: new OccSubFaceShape(this.shape, data.faces[i], i),
+                start: group[2 * i],
+                count: group[2 * i + 1],
+                shape: new OccSubFaceShape(this.shape, faces[i], i),
             });
         }
         return result;
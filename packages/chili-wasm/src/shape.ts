@@ -6,6 +6,7 @@ import {
     gc,
     type ICompound,
     type ICompoundSolid,
+    type HlrLines,
     type ICurve,
     IDisposable,
     Id,
@@ -63,6 +64,25 @@ function occShapeDeserialize(shape: string, id: string) {
     return tshape;
 }
 
+let isPruneScheduled = false;
+
+/**
+ * Lets the kernel caches drop what only they still hold once the shapes disposed in the same task are
+ * gone, one pass for all of them.
+ */
+function schedulePruneCaches() {
+    if (isPruneScheduled) {
+        return;
+    }
+    isPruneScheduled = true;
+    queueMicrotask(() => {
+        isPruneScheduled = false;
+        // the ShapeCache entries of a disposed solid hold its faces, which keep their MeshCache entries
+        wasm.ShapeCache.prune();
+        wasm.MeshCache.prune();
+    });
+}
+
 @Serializer.register(["shape", "id"], occShapeDeserialize, occShapeSerialize)
 export class OccShape implements IShape {
     readonly shapeType: ShapeType;
@@ -128,7 +148,7 @@ export class OccShape implements IShape {
         occMesher.delete();
         return {
             lineType: LineType.Solid,
-            position: new Float32Array(position),
+            position,
             range: [],
             color: VisualConfig.defaultEdgeColor,
         };
@@ -239,6 +259,28 @@ export class OccShape implements IShape {
         });
     }
 
+    hlrLines(position: XYZLike, direction: XYZLike, xDir: XYZLike, deflection?: number): HlrLines {
+        return gc((c) => {
+            const point = c(OcctHelper.toPnt(position));
+            const dir = c(OcctHelper.toDir(direction));
+            const xDirection = c(OcctHelper.toDir(xDir));
+            const result = c(
+                deflection === undefined
+                    ? wasm.Shape.hlrExact(this.shape, point, dir, xDirection)
+                    : wasm.Shape.hlrPolygonal(this.shape, point, dir, xDirection, deflection),
+            );
+            const wrap = (shape: TopoDS_Shape) => (shape.isNull() ? undefined : OcctHelper.wrapShape(shape));
+            return {
+                visible: wrap(result.visible),
+                visibleSmooth: wrap(result.visibleSmooth),
+                visibleOutline: wrap(result.visibleOutline),
+                hidden: wrap(result.hidden),
+                hiddenSmooth: wrap(result.hiddenSmooth),
+                hiddenOutline: wrap(result.hiddenOutline),
+            };
+        });
+    }
+
     #isDisposed = false;
     readonly dispose = () => {
         if (!this.#isDisposed) {
@@ -251,6 +293,7 @@ export class OccShape implements IShape {
         this._shape.nullify();
         this._shape.delete();
         this._shape = null as any;
+        schedulePruneCaches();
 
         if (this._mesh && IDisposable.isDisposable(this._mesh)) {
             this._mesh.dispose();
@@ -7,7 +7,27 @@ declare global {
     var wasm: MainModule;
 }
 
+/**
+ * The pthreads build (`npm run build:wasm:mt`) is installed into the public folder and
+ * loaded at runtime, it is not part of the bundle.
+ */
+const THREADED_MODULE_URL = "./wasm/chili-wasm-mt.js";
+
+async function initThreadedWasm(): Promise<MainModule | undefined> {
+    // SharedArrayBuffer, and so the worker pool, is only available when cross-origin isolated
+    if (!globalThis.crossOriginIsolated) {
+        return undefined;
+    }
+
+    try {
+        const factory = await import(/* webpackIgnore: true */ THREADED_MODULE_URL);
+        return (await factory.default()) as MainModule;
+    } catch {
+        return undefined;
+    }
+}
+
 export async function initWasm() {
-    global.wasm = await MainModuleFactory();
+    global.wasm = (await initThreadedWasm()) ?? (await MainModuleFactory());
     return global.wasm;
 }
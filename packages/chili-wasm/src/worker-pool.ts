@@ -0,0 +1,151 @@
+// Part of the Chili3d Project, under the AGPL-3.0 License.
+// See LICENSE file in the project root for full license information.
+
+import { type IDisposable, type IShape, Result } from "chili-core";
+import { LINE_DEFLECTION, Mesher } from "./mesher";
+import { OccShape } from "./shape";
+import {
+    collectTransferables,
+    type ImportedNode,
+    type WorkerMethod,
+    type WorkerOperations,
+    type WorkerRequest,
+    type WorkerResponse,
+} from "./worker-protocol";
+
+interface PendingCall {
+    resolve: (value: any) => void;
+    reject: (reason: Error) => void;
+}
+
+interface PoolWorker {
+    worker: Worker;
+    pending: Map<number, PendingCall>;
+}
+
+/**
+ * Runs imports, booleans and meshing on wasm modules of their own in web workers, so independent parts
+ * are processed on several cores and the main thread stays responsive, also without the pthreads build.
+ * Shapes go to the workers as binary BRep, results come back as wasm.MeshContainer buffers that are
+ * transferred, not copied, and open on the main thread already meshed. The results are new shapes,
+ * their sub shapes are not those of the inputs. Workers start on first use.
+ */
+export class WasmWorkerPool implements IDisposable {
+    private readonly workers: PoolWorker[] = [];
+    private nextId = 0;
+
+    constructor(readonly size: number = Math.max(1, (globalThis.navigator?.hardwareConcurrency ?? 2) - 1)) {}
+
+    /**
+     * Reads a STEP file in a worker. The nodes contain meshed MeshContainer buffers, see
+     * OccShapeConverter.convertFromImportedNode.
+     */
+    importStep(data: Uint8Array): Promise<ImportedNode | undefined> {
+        return this.call("importStep", [data.slice(), LINE_DEFLECTION]);
+    }
+
+    importIges(data: Uint8Array): Promise<ImportedNode | undefined> {
+        return this.call("importIges", [data.slice(), LINE_DEFLECTION]);
+    }
+
+    /**
+     * Meshes a copy of the shape in a worker.
+     */
+    mesh(shape: IShape): Promise<Result<OccShape>> {
+        return this.unpackResult(() => this.call("mesh", [this.toBrep(shape), LINE_DEFLECTION]));
+    }
+
+    booleanCommon(args: IShape[], tools: IShape[]): Promise<Result<OccShape>> {
+        return this.boolean("booleanCommon", args, tools);
+    }
+
+    booleanCut(args: IShape[], tools: IShape[]): Promise<Result<OccShape>> {
+        return this.boolean("booleanCut", args, tools);
+    }
+
+    booleanFuse(args: IShape[], tools: IShape[]): Promise<Result<OccShape>> {
+        return this.boolean("booleanFuse", args, tools);
+    }
+
+    dispose() {
+        for (const { worker, pending } of this.workers) {
+            worker.terminate();
+            pending.forEach((call) => call.reject(new Error("Worker pool disposed")));
+        }
+        this.workers.length = 0;
+    }
+
+    private boolean(
+        method: "booleanCommon" | "booleanCut" | "booleanFuse",
+        args: IShape[],
+        tools: IShape[],
+    ): Promise<Result<OccShape>> {
+        return this.unpackResult(() => {
+            const breps = args.map((s) => this.toBrep(s));
+            return this.call(method, [breps, tools.map((s) => this.toBrep(s)), LINE_DEFLECTION]);
+        });
+    }
+
+    private async unpackResult(call: () => Promise<Uint8Array>): Promise<Result<OccShape>> {
+        try {
+            const shape = Mesher.unpack(await call());
+            return shape ? Result.ok(shape) : Result.err("can not convert");
+        } catch (e) {
+            return Result.err(e instanceof Error ? e.message : String(e));
+        }
+    }
+
+    private toBrep(shape: IShape) {
+        if (!(shape instanceof OccShape)) {
+            throw new Error("Shape is not an OccShape");
+        }
+        return wasm.Converter.convertToBinBrep(shape.shape, false);
+    }
+
+    private call<K extends WorkerMethod>(
+        method: K,
+        args: Parameters<WorkerOperations[K]>,
+    ): Promise<ReturnType<WorkerOperations[K]>> {
+        const target = this.leastBusyWorker();
+        const request: WorkerRequest<K> = { id: this.nextId++, method, args };
+        return new Promise((resolve, reject) => {
+            target.pending.set(request.id, { resolve, reject });
+            target.worker.postMessage(request, { transfer: collectTransferables(args) });
+        });
+    }
+
+    private leastBusyWorker(): PoolWorker {
+        let best = this.workers.find((w) => w.pending.size === 0);
+        if (!best && this.workers.length < this.size) {
+            best = this.createWorker();
+        }
+        return best ?? this.workers.reduce((a, b) => (b.pending.size < a.pending.size ? b : a));
+    }
+
+    private createWorker(): PoolWorker {
+        const worker = new Worker(new URL("./worker.ts", import.meta.url), { type: "module" });
+        const poolWorker: PoolWorker = { worker, pending: new Map() };
+        worker.onmessage = (event: MessageEvent<WorkerResponse>) => {
+            const response = event.data;
+            const call = poolWorker.pending.get(response.id);
+            poolWorker.pending.delete(response.id);
+            if ("error" in response) {
+                call?.reject(new Error(response.error));
+            } else {
+                call?.resolve(response.value);
+            }
+        };
+        worker.onerror = (event) => {
+            // a worker that fails to load the module cannot answer any of its calls, a later one replaces it
+            poolWorker.pending.forEach((call) => call.reject(new Error(event.message)));
+            poolWorker.pending.clear();
+            worker.terminate();
+            const index = this.workers.indexOf(poolWorker);
+            if (index >= 0) {
+                this.workers.splice(index, 1);
+            }
+        };
+        this.workers.push(poolWorker);
+        return poolWorker;
+    }
+}
@@ -0,0 +1,57 @@
+// Part of the Chili3d Project, under the AGPL-3.0 License.
+// See LICENSE file in the project root for full license information.
+
+/**
+ * A node of a STEP or IGES import done in a worker. Shapes travel as wasm.MeshContainer buffers, so
+ * they arrive meshed. Instances of an XCAF prototype only carry the buffer the first time the
+ * prototype appears, later ones reuse it and are placed by matrix.
+ */
+export interface ImportedNode {
+    name: string;
+    color?: string;
+    shape?: Uint8Array;
+    prototypeId: number;
+    /**
+     * The column major location of a prototype instance.
+     */
+    matrix?: number[];
+    children: ImportedNode[];
+}
+
+/**
+ * What a pool worker runs, shapes come and go as binary BRep or MeshContainer buffers.
+ */
+export interface WorkerOperations {
+    importStep(data: Uint8Array, lineDeflection: number): ImportedNode | undefined;
+    importIges(data: Uint8Array, lineDeflection: number): ImportedNode | undefined;
+    mesh(brep: Uint8Array, lineDeflection: number): Uint8Array;
+    booleanCommon(args: Uint8Array[], tools: Uint8Array[], lineDeflection: number): Uint8Array;
+    booleanCut(args: Uint8Array[], tools: Uint8Array[], lineDeflection: number): Uint8Array;
+    booleanFuse(args: Uint8Array[], tools: Uint8Array[], lineDeflection: number): Uint8Array;
+}
+
+export type WorkerMethod = keyof WorkerOperations;
+
+export interface WorkerRequest<K extends WorkerMethod = WorkerMethod> {
+    id: number;
+    method: K;
+    args: Parameters<WorkerOperations[K]>;
+}
+
+export type WorkerResponse = { id: number; value: unknown } | { id: number; error: string };
+
+/**
+ * The buffers of the typed arrays in value, nested in arrays and objects, to transfer instead of copy.
+ */
+export function collectTransferables(value: unknown, buffers: Set<ArrayBuffer> = new Set()): ArrayBuffer[] {
+    if (ArrayBuffer.isView(value)) {
+        if (value.buffer instanceof ArrayBuffer) {
+            buffers.add(value.buffer);
+        }
+    } else if (Array.isArray(value)) {
+        value.forEach((item) => collectTransferables(item, buffers));
+    } else if (value !== null && typeof value === "object") {
+        Object.values(value).forEach((item) => collectTransferables(item, buffers));
+    }
+    return [...buffers];
+}
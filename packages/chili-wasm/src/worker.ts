@@ -0,0 +1,133 @@
+// Part of the Chili3d Project, under the AGPL-3.0 License.
+// See LICENSE file in the project root for full license information.
+
+/**
+ * The entry of a WasmWorkerPool worker. Every worker runs its own single threaded wasm module and only
+ * imports the module and the protocol, not chili-core.
+ */
+
+import MainModuleFactory, {
+    type MainModule,
+    type ShapeNode,
+    type ShapeResult,
+    type TopoDS_Shape,
+} from "../lib/chili-wasm";
+import {
+    collectTransferables,
+    type ImportedNode,
+    type WorkerOperations,
+    type WorkerRequest,
+    type WorkerResponse,
+} from "./worker-protocol";
+
+type Owned = { delete(): void };
+
+const modulePromise: Promise<MainModule> = MainModuleFactory();
+
+/**
+ * Runs action with a collector for the embind objects it creates, they are deleted afterwards.
+ */
+function owning<T>(action: (c: <O extends Owned>(o: O) => O) => T): T {
+    const owned: Owned[] = [];
+    try {
+        return action((o) => {
+            owned.push(o);
+            return o;
+        });
+    } finally {
+        owned.forEach((o) => o.delete());
+    }
+}
+
+function createOperations(wasm: MainModule): WorkerOperations {
+    const fromBreps = (c: <O extends Owned>(o: O) => O, breps: Uint8Array[]) =>
+        breps.map((brep) => c(wasm.Converter.convertFromBinBrep(brep)));
+
+    const boolean =
+        (operate: (args: TopoDS_Shape[], tools: TopoDS_Shape[]) => ShapeResult) =>
+        (args: Uint8Array[], tools: Uint8Array[], lineDeflection: number) =>
+            owning((c) => {
+                const result = c(operate(fromBreps(c, args), fromBreps(c, tools)));
+                if (!result.isOk) {
+                    throw new Error(result.error);
+                }
+                return wasm.MeshContainer.write(c(result.shape), lineDeflection);
+            });
+
+    const toMatrix = (c: <O extends Owned>(o: O) => O, node: ShapeNode) => {
+        const trsf = c(c(node.location).transformation());
+        return [1, 2, 3, 4].flatMap((column) => [
+            trsf.value(1, column),
+            trsf.value(2, column),
+            trsf.value(3, column),
+            column === 4 ? 1 : 0,
+        ]);
+    };
+
+    const toImportedNode = (
+        c: <O extends Owned>(o: O) => O,
+        node: ShapeNode,
+        sentPrototypes: Set<number>,
+        lineDeflection: number,
+    ): ImportedNode => {
+        const imported: ImportedNode = {
+            name: node.name,
+            color: node.color as string | undefined,
+            prototypeId: node.prototypeId,
+            children: [],
+        };
+        const nodeShape = node.shape;
+        const shape = nodeShape && c(nodeShape);
+        if (shape && !shape.isNull()) {
+            if (node.prototypeId < 0) {
+                imported.shape = wasm.MeshContainer.write(shape, lineDeflection);
+            } else {
+                imported.matrix = toMatrix(c, node);
+                if (!sentPrototypes.has(node.prototypeId)) {
+                    sentPrototypes.add(node.prototypeId);
+                    imported.shape = wasm.MeshContainer.write(c(node.prototype!), lineDeflection);
+                }
+            }
+        }
+        imported.children = node
+            .getChildren()
+            .map((child) => toImportedNode(c, c(child), sentPrototypes, lineDeflection));
+        return imported;
+    };
+
+    const importer = (convert: (data: Uint8Array) => ShapeNode | undefined) => {
+        return (data: Uint8Array, lineDeflection: number) =>
+            owning((c) => {
+                const node = convert(data);
+                return node ? toImportedNode(c, c(node), new Set(), lineDeflection) : undefined;
+            });
+    };
+
+    return {
+        importStep: importer((data) => wasm.Converter.convertFromStep(data)),
+        importIges: importer((data) => wasm.Converter.convertFromIges(data)),
+        mesh: (brep, lineDeflection) =>
+            owning((c) => {
+                const shape = c(wasm.Converter.convertFromBinBrep(brep));
+                return wasm.MeshContainer.write(shape, lineDeflection);
+            }),
+        booleanCommon: boolean((args, tools) => wasm.ShapeFactory.booleanCommon(args, tools)),
+        booleanCut: boolean((args, tools) => wasm.ShapeFactory.booleanCut(args, tools)),
+        booleanFuse: boolean((args, tools) => wasm.ShapeFactory.booleanFuse(args, tools)),
+    };
+}
+
+const operationsPromise = modulePromise.then(createOperations);
+
+self.onmessage = async (event: MessageEvent<WorkerRequest>) => {
+    const { id, method, args } = event.data;
+    let response: WorkerResponse;
+    try {
+        const operations = await operationsPromise;
+        const operation = operations[method] as (...a: unknown[]) => unknown;
+        response = { id, value: operation(...args) };
+    } catch (e) {
+        response = { id, error: e instanceof Error ? e.message : String(e) };
+    }
+    self.postMessage(response, { transfer: collectTransferables(response) });
+};
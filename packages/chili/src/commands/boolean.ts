@@ -45,7 +45,9 @@ export abstract class BooleanOperate extends MultistepCommand {
             case "common":
                 return this.application.shapeFactory.booleanCommon([shape1], tools);
             case "cut":
-                return this.application.shapeFactory.booleanCut([shape1], tools);
+                return tools.length > 1
+                    ? this.application.shapeFactory.booleanCutMany(shape1, tools)
+                    : this.application.shapeFactory.booleanCut([shape1], tools);
             default:
                 return this.application.shapeFactory.booleanFuse([shape1], tools);
         }